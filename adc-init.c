@@ -179,4 +179,3 @@ void adc_read_i( uint8_t channel )
   //return ADCW;                    // ADC auslesen und zurckgeben
   
 }/* adc_read */
-
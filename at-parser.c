@@ -0,0 +1,349 @@
+/*************************************************************************
+Title:		AT response parser
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		at-parser.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description:	Streaming tokenizer for SIM900 responses
+Usage:		see at-parser.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/pgmspace.h>
+	#include "at-parser.h"
+
+// Parser states
+#define ST_HEADER	0	// matching the header
+#define ST_FIELD	1	// waiting for the next field
+#define ST_NUMBER	2	// inside a number
+#define ST_STRING	3	// inside a quoted string
+#define ST_AFTER	4	// after a field, waiting for ',' or end of line
+#define ST_TEXT		5	// SMS text line
+#define ST_SKIP		6	// unknown line, wait for end of line
+
+// Header candidates, index+1 == AT_RESP_xxx
+#define AT_PREFIX_NR	7
+#define AT_PREFIX_LEN	7
+static const char at_prefix[AT_PREFIX_NR][AT_PREFIX_LEN] PROGMEM = {
+	"+CSQ:",
+	"+CREG:",
+	"+CMTI:",
+	"+CMGR:",
+	"+CMGL:",
+	"OK",
+	"ERROR"
+};
+#define AT_PREFIX_ALL	((1<<AT_PREFIX_NR)-1)
+#define AT_PREFIX_CMGL	(1<<(AT_RESP_CMGL-1))
+
+/*	rssi	dBm		%		bars
+	0		-113	0		0
+	1..6	-111..	3..19	1
+	7..12	-99..	23..39	2
+	13..18	-87..	42..58	3
+	19..26	-75..	61..84	4
+	27..31	-59..	87..100	5
+	https://www.lte-anbieter.info/Bilder/technik/empfang/asu-2g.png */
+static const uint8_t at_rssi_tab[32][2] PROGMEM = {
+	{  0,0},{  3,1},{  6,1},{ 10,1},{ 13,1},{ 16,1},{ 19,1},{ 23,2},
+	{ 26,2},{ 29,2},{ 32,2},{ 35,2},{ 39,2},{ 42,3},{ 45,3},{ 48,3},
+	{ 52,3},{ 55,3},{ 58,3},{ 61,4},{ 65,4},{ 68,4},{ 71,4},{ 74,4},
+	{ 77,4},{ 81,4},{ 84,4},{ 87,5},{ 90,5},{ 94,5},{ 97,5},{100,5}
+};
+
+/*************************************************************************
+Function: at_line_start()
+Purpose:  Reset the per line state
+Input:    parser
+Returns:  none
+**************************************************************************/
+static void at_line_start(at_parser_t *p)
+{
+	p->pos = 0;
+	p->match = AT_PREFIX_ALL;
+	if (p->text) {
+		p->state = ST_TEXT;
+	}
+	else {
+		p->state = ST_HEADER;
+	}
+}
+
+/*************************************************************************
+Function: at_final()
+Purpose:  Line is a final result code (OK, ERROR)
+Input:    parser at the end of a line
+Returns:  AT_RESP_OK, AT_RESP_ERROR or AT_RESP_NONE
+**************************************************************************/
+static uint8_t at_final(at_parser_t *p)
+{
+	uint8_t k;
+
+	for (k=AT_RESP_OK-1; k<=AT_RESP_ERROR-1; k++) {
+		if ((p->match & (1<<k)) && (p->pos < AT_PREFIX_LEN) &&
+			(pgm_read_byte(&at_prefix[k][p->pos]) == '\0')) {
+			return k+1;
+		}
+	}
+	return AT_RESP_NONE;
+}
+
+/*************************************************************************
+Function: at_text_sep()
+Purpose:  Line feeds in front of the next SMS text line
+Input:    parser
+Returns:  one for the line before and one per blank line
+**************************************************************************/
+static uint8_t at_text_sep(at_parser_t *p)
+{
+	return p->blank + (p->tlen ? 1 : 0);
+}
+
+/*************************************************************************
+Function: at_store_number()
+Purpose:  Store the accumulated number as next integer field
+Input:    parser
+Returns:  none
+**************************************************************************/
+static void at_store_number(at_parser_t *p)
+{
+	at_resp_t *r = p->resp;
+
+	if (r->n_int < AT_MAX_INT) {
+		r->val[r->n_int++] = p->neg ? -p->acc : p->acc;
+	}
+}
+
+/*************************************************************************
+Function: at_parser_init()
+Purpose:  Initialize the parser
+Input:    parser, destination
+Returns:  none
+**************************************************************************/
+void at_parser_init(at_parser_t *p, at_resp_t *resp)
+{
+	p->resp = resp;
+	p->text = 0;
+	p->blank = 0;
+	p->tlen = 0;
+	resp->type = AT_RESP_NONE;
+	resp->n_int = 0;
+	resp->n_str = 0;
+	resp->text[0] = '\0';
+	at_line_start(p);
+}
+
+/*************************************************************************
+Function: at_parse_char()
+Purpose:  Feed one character
+Input:    parser, character
+Returns:  AT_RESP_xxx when a line is complete
+**************************************************************************/
+uint8_t at_parse_char(at_parser_t *p, char c)
+{
+	at_resp_t *r = p->resp;
+	uint8_t k, m, type;
+
+	if (c == '\r') {
+		return AT_RESP_NONE;
+	}
+
+	if (c == '\n') {
+		type = AT_RESP_NONE;
+		switch (p->state) {
+			case ST_HEADER:
+				// Lines without fields: OK, ERROR
+				for (k=0, m=1; k<AT_PREFIX_NR; k++, m<<=1) {
+					if ((p->match & m) && (p->pos != 0) &&
+						(pgm_read_byte(&at_prefix[k][p->pos]) == '\0')) {
+						type = k+1;
+						r->type = type;
+						r->n_int = 0;
+						r->n_str = 0;
+						break;
+					}
+				}
+				break;
+			case ST_TEXT:
+				if (p->pos == 0) {		// blank line: end of the text or part of it
+					if (p->blank < AT_TEXT_LEN) p->blank++;
+					return AT_RESP_NONE;
+				}
+				if (p->blank && at_final(p)) {	// blank line and OK: text complete
+					p->text = 0;
+					type = AT_RESP_TEXT;
+				}
+				else {					// text line, e.g. a SMS "OK" too
+					k = at_text_sep(p);
+					p->tlen = (p->tlen + k + p->pos < AT_TEXT_LEN-1) ?
+							  p->tlen + k + p->pos : AT_TEXT_LEN-1;
+					p->blank = 0;
+				}
+				r->text[p->tlen] = '\0';
+				break;
+			case ST_NUMBER:
+				at_store_number(p);
+				/* fall through */
+			case ST_FIELD:
+			case ST_AFTER:
+				type = r->type;
+				break;
+			case ST_STRING:				// unterminated string
+				if (r->n_str < AT_MAX_STR) {
+					r->str[r->n_str][p->pos] = '\0';
+					r->n_str++;
+				}
+				type = r->type;
+				break;
+		}
+		if ((type == AT_RESP_CMGR) || (type == AT_RESP_CMGL)) {
+			p->text = 1;				// SMS text follows
+			p->blank = 0;
+			p->tlen = 0;
+			r->text[0] = '\0';
+		}
+		at_line_start(p);
+		return type;
+	}
+
+	switch (p->state) {
+		case ST_HEADER:
+			// Drop every candidate that differs at this position
+			for (k=0, m=1; k<AT_PREFIX_NR; k++, m<<=1) {
+				if ((p->match & m) && (pgm_read_byte(&at_prefix[k][p->pos]) != c)) {
+					p->match &= ~m;
+				}
+			}
+			if (p->match == 0) {
+				p->state = ST_SKIP;
+				break;
+			}
+			if (c == ':') {				// complete +XXXX: header found
+				for (k=0, m=1; !(p->match & m); k++, m<<=1);
+				r->type = k+1;
+				r->n_int = 0;
+				r->n_str = 0;
+				p->state = ST_FIELD;
+				break;
+			}
+			p->pos++;
+			if (p->pos >= AT_PREFIX_LEN-1) {
+				p->state = ST_SKIP;
+			}
+			break;
+
+		case ST_FIELD:
+			if (c == '"') {
+				p->pos = 0;
+				p->state = ST_STRING;
+			}
+			else if ((c >= '0') && (c <= '9')) {
+				p->acc = c-'0';
+				p->neg = 0;
+				p->state = ST_NUMBER;
+			}
+			else if (c == '-') {
+				p->acc = 0;
+				p->neg = 1;
+				p->state = ST_NUMBER;
+			}
+			break;						// ' ' and empty fields are skipped
+
+		case ST_NUMBER:
+			if ((c >= '0') && (c <= '9')) {
+				p->acc = p->acc*10 + (c-'0');
+			}
+			else {
+				at_store_number(p);
+				p->state = (c == ',') ? ST_FIELD : ST_AFTER;
+			}
+			break;
+
+		case ST_STRING:
+			if (r->n_str >= AT_MAX_STR) {	// no room left, just skip the string
+				if (c == '"') {
+					p->state = ST_AFTER;
+				}
+				break;
+			}
+			if (c == '"') {
+				r->str[r->n_str][p->pos] = '\0';
+				r->n_str++;
+				p->state = ST_AFTER;
+			}
+			else if (p->pos < AT_STR_LEN-1) {
+				r->str[r->n_str][p->pos++] = c;
+			}
+			break;
+
+		case ST_AFTER:
+			if (c == ',') {
+				p->state = ST_FIELD;
+			}
+			break;
+
+		case ST_TEXT:
+			// the header candidates are matched too: OK, ERROR, +CMGL:
+			if (p->pos < AT_PREFIX_LEN-1) {
+				for (k=0, m=1; k<AT_PREFIX_NR; k++, m<<=1) {
+					if ((p->match & m) && (pgm_read_byte(&at_prefix[k][p->pos]) != c)) {
+						p->match &= ~m;
+					}
+				}
+			}
+			else {
+				p->match = 0;
+			}
+			if ((c == ':') && (p->match & AT_PREFIX_CMGL) && (r->type == AT_RESP_CMGL)) {
+				r->text[p->tlen] = '\0';	// next entry of the list
+				p->text = 0;
+				r->n_int = 0;
+				r->n_str = 0;
+				p->state = ST_FIELD;
+				return AT_RESP_TEXT;
+			}
+			// written behind the text, taken at the end of the line
+			k = at_text_sep(p);
+			if (p->pos == 0) {
+				for (m=0; m<k; m++) {
+					if (p->tlen + m < AT_TEXT_LEN-1) r->text[p->tlen + m] = '\n';
+				}
+			}
+			if (p->tlen + k + p->pos < AT_TEXT_LEN-1) {
+				r->text[p->tlen + k + p->pos] = c;
+			}
+			if (p->pos < AT_TEXT_LEN) p->pos++;
+			break;
+
+		default:						// ST_SKIP
+			break;
+	}
+	return AT_RESP_NONE;
+}
+
+/*************************************************************************
+Function: at_rssi_percent()
+Purpose:  Signal strength of +CSQ
+Input:    rssi
+Returns:  percent
+**************************************************************************/
+uint8_t at_rssi_percent(uint8_t rssi)
+{
+	if (rssi > 31) {
+		return 0;						// 99 ... unknown
+	}
+	return pgm_read_byte(&at_rssi_tab[rssi][0]);
+}
+
+/*************************************************************************
+Function: at_rssi_bars()
+Purpose:  Signal bars of +CSQ
+Input:    rssi
+Returns:  bars 0..5
+**************************************************************************/
+uint8_t at_rssi_bars(uint8_t rssi)
+{
+	if (rssi > 31) {
+		return 0;
+	}
+	return pgm_read_byte(&at_rssi_tab[rssi][1]);
+}
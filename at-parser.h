@@ -0,0 +1,134 @@
+/*************************************************************************
+Title:		AT response parser
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		at-parser.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description: 	Streaming tokenizer for SIM900 responses
+Usage:		Feed every received character to at_parse_char()
+*************************************************************************/
+
+#ifndef AT_PARSER_H
+	#define AT_PARSER_H
+
+/**
+ *  @defgroup moe_AT AT-Parser
+ *  @code #include <at-parser.h> @endcode
+ *
+ *  @brief Single-pass parser for SIM900 AT responses
+ *
+ *	The parser is fed byte by byte (e.g. straight from uart_getc()).
+ *	The header (+CSQ:, +CREG:, +CMTI:, +CMGR:, +CMGL:, OK, ERROR) is
+ *	matched on the fly, numbers are accumulated directly and quoted
+ *	strings are written directly into the result structure.
+ *	The lines following +CMGR/+CMGL are the SMS text (joined by '\n'),
+ *	it ends with a blank line and the final OK (or ERROR), which is
+ *	reported as AT_RESP_TEXT; a text line "OK" stays text. An empty SMS
+ *	gives an empty text. In a +CMGL list the next +CMGL: header ends the
+ *	text of the entry before, AT_RESP_TEXT is returned on its ':'.
+ *
+ *	Field layout of the result:
+ *	- +CSQ:  val[0]=rssi, val[1]=ber
+ *	- +CREG: val[0]=n, val[1]=stat (unsolicited: val[0]=stat)
+ *	- +CMTI: str[0]=mem, val[0]=index
+ *	- +CMGR: str[0]=stat, str[1]=phone, str[2]=alpha, str[3]=time
+ *	- +CMGL: val[0]=index, str[0..3] like +CMGR
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#ifndef AT_MAX_INT
+	#define AT_MAX_INT		4	// number of integer fields per line
+#endif
+#ifndef AT_MAX_STR
+	#define AT_MAX_STR		4	// number of quoted fields per line
+#endif
+#ifndef AT_STR_LEN
+	#define AT_STR_LEN		21	// "19/12/27,12:00:21+04" + '\0'
+#endif
+#ifndef AT_TEXT_LEN
+	#define AT_TEXT_LEN		33	// SMS text following +CMGR/+CMGL, cut off
+#endif
+
+// Response types, return value of at_parse_char()
+#define AT_RESP_NONE	0	// line not complete or not recognized
+#define AT_RESP_CSQ		1
+#define AT_RESP_CREG	2
+#define AT_RESP_CMTI	3
+#define AT_RESP_CMGR	4
+#define AT_RESP_CMGL	5
+#define AT_RESP_OK		6
+#define AT_RESP_ERROR	7
+#define AT_RESP_TEXT	8	// SMS text, see at_resp_t.text
+
+#define AT_RSSI_UNKNOWN	99	// +CSQ: 99 -> not known or not detectable
+
+/** @brief Typed fields of one response line */
+typedef struct {
+	uint8_t type;					// AT_RESP_xxx
+	uint8_t n_int;					// number of valid entries in val[]
+	uint8_t n_str;					// number of valid entries in str[]
+	int16_t val[AT_MAX_INT];		// numeric fields in order of appearance
+	char str[AT_MAX_STR][AT_STR_LEN];	// quoted fields in order of appearance
+	char text[AT_TEXT_LEN];			// SMS text
+} at_resp_t;
+
+/** @brief State of the tokenizer */
+typedef struct {
+	uint8_t state;
+	uint8_t pos;		// header position, string or text line length
+	uint8_t match;		// bitmask of header candidates
+	uint8_t neg;		// sign of current number
+	uint8_t text;		// next line is SMS text
+	uint8_t blank;		// blank lines behind the SMS text
+	uint8_t tlen;		// length of the SMS text
+	int16_t acc;		// current number
+	at_resp_t *resp;	// destination
+} at_parser_t;
+
+/**
+ *	@brief   Initialize the parser
+ *
+ *  @param p 	Parser state
+ *  @param resp	Destination of the parsed fields
+ * 	@return  none
+*/
+void at_parser_init(at_parser_t *p, at_resp_t *resp);
+
+/**
+ *	@brief   Feed one received character to the parser
+ *
+ *	'\r' is ignored, '\n' terminates a line.
+ *	The fields in resp are valid until the next line starts.
+ *
+ *  @param p 	Parser state
+ *  @param c	Received character
+ * 	@return  AT_RESP_xxx when a line is complete, otherwise AT_RESP_NONE
+*/
+uint8_t at_parse_char(at_parser_t *p, char c);
+
+/**
+ *	@brief   Convert +CSQ rssi (0..31, 99) to signal strength
+ *
+ *  @param rssi	Value of +CSQ
+ * 	@return  Signal strength in percent (0..100)
+*/
+uint8_t at_rssi_percent(uint8_t rssi);
+
+/**
+ *	@brief   Convert +CSQ rssi (0..31, 99) to signal bars
+ *
+ *  @param rssi	Value of +CSQ
+ * 	@return  Number of bars (0..5)
+*/
+uint8_t at_rssi_bars(uint8_t rssi);
+
+/**@}*/
+
+#endif
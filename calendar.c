@@ -0,0 +1,173 @@
+/*************************************************************************
+Title:		Calendar
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		calendar.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description:	Unix time to date and time and back, formatting
+Usage:		see calendar.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <string.h>
+	#include <avr/pgmspace.h>
+	#include "soft-clock.h"
+	#include "calendar.h"
+
+#define CAL_CYCLE_DAYS		1461		// 4 years, the first is a leap year
+
+// Days of the year before the month (no leap year)
+static const uint16_t cal_mstart[12] PROGMEM = {
+	0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+/*************************************************************************
+Function: cal_to_unix()
+Purpose:  Unix time of a date and time
+Input:    date and time
+Returns:  seconds since 1970-01-01
+**************************************************************************/
+uint32_t cal_to_unix(const clk_time_t *t)
+{
+	uint16_t days;
+
+	days = t->year * 365U + (t->year + 3) / 4	// leap days of the years before
+		 + pgm_read_word(&cal_mstart[(t->month - 1) % 12]) + t->day - 1;
+	if (t->month > 2 && (t->year & 3) == 0) days++;
+	return CAL_UNIX_2000 + days * CAL_DAY_SEC
+		 + (uint32_t)t->hour * 3600 + t->min * 60U + t->sec;
+}
+
+/*************************************************************************
+Function: cal_from_unix()
+Purpose:  Date and time of a Unix time
+Input:    seconds since 1970-01-01, destination
+Returns:  none
+**************************************************************************/
+void cal_from_unix(uint32_t s, clk_time_t *t)
+{
+	uint16_t days, r, start;
+	uint8_t y, m, leap;
+
+	s = (s > CAL_UNIX_2000) ? s - CAL_UNIX_2000 : 0;
+	days = s / CAL_DAY_SEC;
+	r = s % CAL_DAY_SEC / 60;				// minutes of the day
+	t->sec = s % 60;
+	t->min = r % 60;
+	t->hour = r / 60;
+
+	y = (days / CAL_CYCLE_DAYS) * 4;
+	r = days % CAL_CYCLE_DAYS;				// day of the cycle
+	leap = r < 366;
+	if (!leap) {
+		y += (r - 1) / 365;
+		r = (r - 1) % 365;					// day of the year
+	}
+	t->year = y;
+
+	for (m = 11; ; m--) {					// table of the months
+		start = pgm_read_word(&cal_mstart[m]);
+		if (leap && m >= 2) start++;
+		if (r >= start) break;
+	}
+	t->month = m + 1;
+	t->day = r - start + 1;
+}
+
+/*************************************************************************
+Function: cal_weekday()
+Purpose:  Day of the week
+Input:    seconds since 1970-01-01
+Returns:  0 = Monday .. 6 = Sunday
+**************************************************************************/
+uint8_t cal_weekday(uint32_t s)
+{
+	return (s / CAL_DAY_SEC + 3) % 7;		// 1970-01-01 was a Thursday
+}
+
+/*************************************************************************
+Function: cal_put2()
+Purpose:  Two digits
+Input:    destination, 0..99
+Returns:  position behind the digits
+**************************************************************************/
+static char *cal_put2(char *dst, uint8_t v)
+{
+	*dst++ = '0' + v / 10;
+	*dst++ = '0' + v % 10;
+	return dst;
+}
+
+/*************************************************************************
+Function: cal_format_time()
+Purpose:  Format the time as hh:mm:ss
+Input:    destination, time
+Returns:  destination
+**************************************************************************/
+char *cal_format_time(char *dst, const clk_time_t *t)
+{
+	char *p = dst;
+
+	p = cal_put2(p, t->hour);
+	*p++ = ':';
+	p = cal_put2(p, t->min);
+	*p++ = ':';
+	p = cal_put2(p, t->sec);
+	*p = '\0';
+	return dst;
+}
+
+/*************************************************************************
+Function: cal_format_date()
+Purpose:  Format the date as YYYY-MM-DD
+Input:    destination, date
+Returns:  destination
+**************************************************************************/
+char *cal_format_date(char *dst, const clk_time_t *t)
+{
+	char *p = dst;
+
+	p = cal_put2(p, 20);
+	p = cal_put2(p, t->year);
+	*p++ = '-';
+	p = cal_put2(p, t->month);
+	*p++ = '-';
+	p = cal_put2(p, t->day);
+	*p = '\0';
+	return dst;
+}
+
+/*************************************************************************
+Function: cal_get2()
+Purpose:  Two digits
+Input:    text
+Returns:  0..99 or 0xFF if not two digits
+**************************************************************************/
+static uint8_t cal_get2(const char *s)
+{
+	if (s[0] < '0' || s[0] > '9' || s[1] < '0' || s[1] > '9') return 0xFF;
+	return (s[0] - '0') * 10 + (s[1] - '0');
+}
+
+/*************************************************************************
+Function: cal_parse()
+Purpose:  Read "YYYY-MM-DD hh:mm:ss"
+Input:    text, destination
+Returns:  1 valid date and time, 0 else (destination undefined)
+**************************************************************************/
+uint8_t cal_parse(const char *s, clk_time_t *t)
+{
+	clk_time_t c;
+
+	if (strlen(s) != 19 || cal_get2(s) != 20 || s[4] != '-' || s[7] != '-'
+		|| s[10] != ' ' || s[13] != ':' || s[16] != ':') return 0;
+	t->year = cal_get2(s + 2);
+	t->month = cal_get2(s + 5);
+	t->day = cal_get2(s + 8);
+	t->hour = cal_get2(s + 11);
+	t->min = cal_get2(s + 14);
+	t->sec = cal_get2(s + 17);
+	if (t->year > 99 || t->month < 1 || t->month > 12 || t->day < 1
+		|| t->hour > 23 || t->min > 59 || t->sec > 59) return 0;
+	cal_from_unix(cal_to_unix(t), &c);		// e.g. 02-30 gives 03-02
+	return c.day == t->day;
+}
@@ -0,0 +1,103 @@
+/*************************************************************************
+Title:		Calendar
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		calendar.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description: 	Unix time to date and time and back, formatting
+Usage:
+*************************************************************************/
+
+#ifndef CALENDAR_H
+	#define CALENDAR_H
+
+/**
+ *  @defgroup moe_CALENDAR Calendar
+ *  @code #include <calendar.h> @endcode
+ *
+ *  @brief Conversion between Unix time (32 bit) and clk_time_t
+ *
+ *	Records carry the time as seconds since 1970-01-01 00:00:00 (UTC or
+ *	local time, like the clock), it is formatted only for the display.
+ *	The conversions use integer math and a table of the month starts:
+ *	the years 2000..2099 have a leap year every 4 years, a cycle of
+ *	4 years has 1461 days, so no loop over the years is needed.
+ *
+ *	@code
+ *	uint32_t stamp = clk_now();
+ *	...
+ *	clk_time_t t;
+ *	char s[CAL_DATE_LEN + 1];
+ *	cal_from_unix(stamp, &t);
+ *	uart_puts(cal_format_date(s, &t));
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define CAL_UNIX_2000		946684800UL	// 2000-01-01 00:00:00
+#define CAL_DAY_SEC			86400UL
+#define CAL_TIME_LEN		8			// hh:mm:ss
+#define CAL_DATE_LEN		10			// YYYY-MM-DD
+
+/**
+ *	@brief   Unix time of a date and time
+ *
+ *  @param t	Date 2000..2099 and time
+ * 	@return  Seconds since 1970-01-01
+*/
+uint32_t cal_to_unix(const clk_time_t *t);
+
+/**
+ *	@brief   Date and time of a Unix time
+ *
+ *  @param s	Seconds since 1970-01-01, before 2000 gives 2000-01-01
+ *  @param t	Destination
+ * 	@return  none
+*/
+void cal_from_unix(uint32_t s, clk_time_t *t);
+
+/**
+ *	@brief   Day of the week
+ *
+ *  @param s	Seconds since 1970-01-01
+ * 	@return  0 = Monday .. 6 = Sunday
+*/
+uint8_t cal_weekday(uint32_t s);
+
+/**
+ *	@brief   Format the time as hh:mm:ss
+ *
+ *  @param dst	Destination, CAL_TIME_LEN+1 chars
+ *  @param t	Time
+ * 	@return  dst
+*/
+char *cal_format_time(char *dst, const clk_time_t *t);
+
+/**
+ *	@brief   Format the date as YYYY-MM-DD
+ *
+ *  @param dst	Destination, CAL_DATE_LEN+1 chars
+ *  @param t	Date
+ * 	@return  dst
+*/
+char *cal_format_date(char *dst, const clk_time_t *t);
+
+/**
+ *	@brief   Read a date and time as YYYY-MM-DD hh:mm:ss
+ *
+ *  @param s	Text, 2000..2099, nothing behind the seconds
+ *  @param t	Destination
+ * 	@return  1 valid date and time, 0 syntax error or no such day
+*/
+uint8_t cal_parse(const char *s, clk_time_t *t);
+
+/**@}*/
+
+#endif
@@ -0,0 +1,118 @@
+/*************************************************************************
+Title:		Display benchmark
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		disp-bench.c, v1.0, 2026/10/19
+Software:	gcc on the host
+Hardware: 	none
+Description:	Bus time of the screen refreshes on the virtual display
+Usage:		gcc -I. -o disp-bench disp-bench.c disp.c disp-virt.c lcd-fb.c
+			./disp-bench	(exit code 1 if a screen is wrong)
+*************************************************************************/
+	#include <stdio.h>
+	#include <stdint.h>
+	#include <string.h>
+	#include "disp.h"
+	#include "disp-virt.h"
+	#include "lcd-fb.h"
+
+static const struct {
+	const char *name;
+	const disp_virt_model_t *model;
+} bench_model[] = {
+	{ "hd44780",	&disp_virt_hd44780 },
+	{ "hd44780_bf",	&disp_virt_hd44780_bf },
+	{ "pcf8574",	&disp_virt_pcf8574 }
+};
+
+static int bench_err;
+
+/*************************************************************************
+Function: bench_line()
+Purpose:  Compare one visible line
+Input:    line 1..4, expected text
+Returns:  none
+**************************************************************************/
+static void bench_line(uint8_t line, const char *expect)
+{
+	char l[DISP_COLS + 1];
+
+	disp_virt_line(line, l);
+	if (strcmp(l, expect) != 0) {
+		printf("  line %u: [%s] expected [%s]\n", line, l, expect);
+		bench_err = 1;
+	}
+}
+
+/*************************************************************************
+Function: bench_report()
+Purpose:  Print the counters of one refresh
+Input:    name of the refresh
+Returns:  none
+**************************************************************************/
+static void bench_report(const char *what)
+{
+	printf("  %-14s cmd %3u data %3u calls %3u bus %6u us\n", what,
+		   (unsigned)disp_virt.n_cmd, (unsigned)disp_virt.n_data,
+		   (unsigned)disp_virt.n_call, (unsigned)disp_virt.bus_us);
+}
+
+int main(void)
+{
+	static const uint8_t glyph[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	uint8_t k;
+
+	for (k = 0; k < sizeof(bench_model)/sizeof(bench_model[0]); k++) {
+		printf("%s\n", bench_model[k].name);
+		disp_virt_model(bench_model[k].model);
+		disp_init(&disp_virtual);
+		lcd_fb_init();
+
+		// start screen of main.c
+		lcd_fb_string(" 0.001", 8, 1);
+		lcd_fb_string("m3", 14, 1);
+		lcd_fb_string(" 2.6", 0, 2);
+		lcd_fb_string("bar", 4, 2);
+		lcd_fb_string("lpm", 13, 2);
+		lcd_fb_string("P", 0, 4);
+		lcd_fb_string("Q", 4, 4);
+		lcd_fb_flush();
+		bench_report("full screen");
+		bench_line(1, "         0.001m3    ");
+		bench_line(2, " 2.6bar      lpm    ");
+
+		// one digit of the flow
+		disp_virt_reset();
+		lcd_fb_string(" 0.002", 8, 1);
+		lcd_fb_flush();
+		bench_report("one digit");
+		bench_line(1, "         0.002m3    ");
+
+		// nothing changed
+		disp_virt_reset();
+		lcd_fb_string(" 2.6", 0, 2);
+		lcd_fb_flush();
+		bench_report("unchanged");
+		if (disp_virt.n_data) {
+			printf("  unchanged text was written\n");
+			bench_err = 1;
+		}
+
+		// glyph rows
+		disp_virt_reset();
+		lcd_fb_glyph(1, 0, glyph, 8);
+		bench_report("glyph");
+		if (disp_virt.cgram[8] != 1 || disp_virt.cgram[15] != 8) {
+			printf("  glyph not in CGRAM\n");
+			bench_err = 1;
+		}
+
+		// after a glyph the cursor has to be set again
+		disp_virt_reset();
+		lcd_fb_string("X", 0, 1);
+		lcd_fb_flush();
+		bench_report("after glyph");
+		bench_line(1, "X        0.002m3    ");
+	}
+	printf(bench_err ? "FAILED\n" : "OK\n");
+	return bench_err;
+}
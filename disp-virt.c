@@ -0,0 +1,158 @@
+/*************************************************************************
+Title:		Virtual display
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		disp-virt.c, v1.0, 2026/10/19
+Software:	gcc on the host
+Hardware: 	none
+Description:	Virtual HD44780 for the display interface
+Usage:		see disp-virt.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <string.h>
+	#include "disp.h"
+	#include "disp-virt.h"
+
+disp_virt_t disp_virt;
+
+// Queued parallel driver: one byte per lcd_tick() (LCD_TICK_US 50us), clear 2ms
+const disp_virt_model_t disp_virt_hd44780 = { 0, 50, 2000, 0 };
+// Same with LCD_RW: busy flag every 20us, a byte after 2 ticks, clear 1.52ms
+const disp_virt_model_t disp_virt_hd44780_bf = { 0, 40, 1540, 0 };
+// PCF8574 at 100kHz: start/address/stop 110us, 4 bytes per LCD byte,
+// runs of I2C_LCD_RUN_MAX chars
+const disp_virt_model_t disp_virt_pcf8574 = { 110, 360, 2000, 20 };
+
+static const disp_virt_model_t *disp_virt_m = &disp_virt_hd44780;
+static uint8_t disp_virt_cg;		// 1 ... data is written to CGRAM
+
+/*************************************************************************
+Function: disp_virt_model()
+Purpose:  Select the timing model
+Input:    model
+Returns:  none
+**************************************************************************/
+void disp_virt_model(const disp_virt_model_t *model)
+{
+	disp_virt_m = model;
+}
+
+/*************************************************************************
+Function: disp_virt_reset()
+Purpose:  Clear the counters
+Input:    none
+Returns:  none
+**************************************************************************/
+void disp_virt_reset(void)
+{
+	disp_virt.n_cmd = 0;
+	disp_virt.n_data = 0;
+	disp_virt.n_call = 0;
+	disp_virt.bus_us = 0;
+}
+
+/*************************************************************************
+Function: disp_virt_line()
+Purpose:  Copy one visible line
+Input:    line 1..4, destination
+Returns:  destination
+**************************************************************************/
+char *disp_virt_line(uint8_t line, char *dst)
+{
+	memcpy(dst, &disp_virt.ddram[disp_adr(0, line)], DISP_COLS);
+	dst[DISP_COLS] = '\0';
+	return dst;
+}
+
+/*
+** Bus operations
+*/
+static void disp_virt_cmd(void)
+{
+	disp_virt.n_cmd++;
+	disp_virt.bus_us += disp_virt_m->byte_us;
+}
+
+static void disp_virt_data(uint8_t c)
+{
+	if (disp_virt_cg) {
+		disp_virt.cgram[disp_virt.adr & 0x3F] = c;
+		disp_virt.adr = (disp_virt.adr + 1) & 0x3F;
+	}
+	else {
+		disp_virt.ddram[disp_virt.adr] = c;
+		disp_virt.adr = disp_next(disp_virt.adr);
+	}
+	disp_virt.n_data++;
+	disp_virt.bus_us += disp_virt_m->byte_us;
+}
+
+static void disp_virt_call(void)
+{
+	disp_virt.n_call++;
+	disp_virt.bus_us += disp_virt_m->call_us;
+}
+
+/*
+** Ops
+*/
+static void disp_virt_clear(void)
+{
+	disp_virt_call();
+	disp_virt_cmd();
+	memset(disp_virt.ddram, ' ', sizeof(disp_virt.ddram));
+	disp_virt.adr = 0;
+	disp_virt_cg = 0;
+	disp_virt.bus_us += disp_virt_m->clear_us;
+}
+
+static void disp_virt_init(void)
+{
+	memset(&disp_virt, 0, sizeof(disp_virt));
+	disp_virt_clear();
+	disp_virt_reset();
+}
+
+static void disp_virt_goto(uint8_t adr)
+{
+	if (!disp_virt_m->run_max) {
+		disp_virt_call();
+		disp_virt_cmd();
+	}
+	disp_virt.adr = adr & 0x7F;
+	disp_virt_cg = 0;
+}
+
+static void disp_virt_write(const char *data, uint8_t len)
+{
+	uint8_t n = 0;
+
+	if (!disp_virt_m->run_max) {
+		disp_virt_call();
+	}
+	while (len--) {
+		if (disp_virt_m->run_max && n-- == 0) {	// next run with its goto
+			n = disp_virt_m->run_max - 1;
+			disp_virt_call();
+			disp_virt_cmd();
+		}
+		disp_virt_data(*data++);
+	}
+}
+
+static void disp_virt_glyph(uint8_t code, uint8_t row, const uint8_t *data, uint8_t n)
+{
+	disp_virt_call();
+	disp_virt_cmd();
+	disp_virt.adr = ((code & 7) << 3) | (row & 7);
+	disp_virt_cg = 1;
+	while (n--) {
+		if (disp_virt_m->run_max) {
+			disp_virt_call();				// a transaction per row
+		}
+		disp_virt_data(*data++);
+	}
+}
+
+const disp_ops_t disp_virtual = {
+	disp_virt_init, disp_virt_goto, disp_virt_write, disp_virt_clear, disp_virt_glyph
+};
@@ -0,0 +1,100 @@
+/*************************************************************************
+Title:		Virtual display
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		disp-virt.h, v1.0, 2026/10/19
+Software:	gcc on the host
+Hardware: 	none
+Description: 	Virtual HD44780 for the display interface
+Usage:		gcc -I. -o disp-bench disp-bench.c disp.c disp-virt.c lcd-fb.c
+*************************************************************************/
+
+#ifndef DISP_VIRT_H
+	#define DISP_VIRT_H
+
+/**
+ *  @defgroup moe_DISP_VIRT Virtual display
+ *  @code #include <disp-virt.h> @endcode
+ *
+ *  @brief Virtual LCD to measure screen refreshes without hardware
+ *
+ *	The backend keeps the DDRAM and CGRAM of a HD44780 and counts the
+ *	bus operations. The bus time is estimated by a timing model, e.g.
+ *	disp_virt_hd44780 (queued parallel driver), disp_virt_hd44780_bf
+ *	(the same with busy flag) or disp_virt_pcf8574 (burst writes at
+ *	100kHz). Like i2c_lcd_write_run(), the PCF8574 model only keeps
+ *	the address on a goto and sends every 20 chars of a write as one
+ *	transaction with a goto; a glyph is a command and a transaction
+ *	per row.
+ *	Only for the host, disp-virt.c is not part of the AVR build.
+ *	disp-bench.c measures the refreshes of main.c with all models and
+ *	checks the screen (exit code 1 on a difference).
+ *
+ *	@code
+ *	disp_virt_model(&disp_virt_pcf8574);
+ *	disp_init(&disp_virtual);
+ *	lcd_fb_init();
+ *	lcd_fb_string("12.3", 0, 2);
+ *	lcd_fb_flush();
+ *	printf("%u us\n", disp_virt.bus_us);
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/** @brief Bus time of one backend in us */
+typedef struct {
+	uint16_t call_us;		// per call of gotoadr/write/clear (transaction)
+	uint16_t byte_us;		// per command or data byte
+	uint16_t clear_us;		// execution time of clear
+	uint8_t run_max;		// 0 ... every op is a transaction, else chars
+							// per write transaction with its own goto
+} disp_virt_model_t;
+
+/** @brief State and counters of the virtual display */
+typedef struct {
+	char ddram[128];		// display data, address 0x00..0x7F
+	uint8_t cgram[64];		// 8 glyphs with 8 rows
+	uint8_t adr;			// address counter
+	uint32_t n_cmd;			// command bytes
+	uint32_t n_data;		// data bytes
+	uint32_t n_call;		// calls of the ops
+	uint32_t bus_us;		// estimated bus time
+} disp_virt_t;
+
+extern disp_virt_t disp_virt;
+extern const disp_ops_t disp_virtual;
+extern const disp_virt_model_t disp_virt_hd44780;
+extern const disp_virt_model_t disp_virt_hd44780_bf;
+extern const disp_virt_model_t disp_virt_pcf8574;
+
+/**
+ *	@brief   Select the timing model (default disp_virt_hd44780)
+ *
+ *  @param model	Timing model
+ * 	@return  none
+*/
+void disp_virt_model(const disp_virt_model_t *model);
+
+/**
+ *	@brief   Clear the counters, the display content is kept
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void disp_virt_reset(void);
+
+/**
+ *	@brief   Copy one visible line of the display
+ *
+ *  @param line	Line 1..4
+ *  @param dst	Destination, at least DISP_COLS+1 chars
+ * 	@return  dst
+*/
+char *disp_virt_line(uint8_t line, char *dst);
+
+/**@}*/
+
+#endif
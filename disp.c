@@ -0,0 +1,156 @@
+/*************************************************************************
+Title:		Display interface
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		disp.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 parallel or over PCF8574
+Description:	Ops table for the character display
+Usage:		see disp.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <stdbool.h>
+	#include "disp.h"
+#ifdef __AVR__
+	#include <avr/pgmspace.h>
+	#include "lcd-routines.h"
+	#include "i2c_lcd.h"
+	#include "i2cmaster.h"
+#else
+	// host build with disp-virt.c
+	#define PROGMEM
+	#define pgm_read_byte(p)	(*(p))
+#endif
+
+const disp_ops_t *disp;
+
+// DDRAM address of column 0 for line 1..4
+static const uint8_t disp_line[DISP_LINES] PROGMEM = {
+	0x00, 0x40, 0x14, 0x54
+};
+
+/*************************************************************************
+Function: disp_init()
+Purpose:  Select and initialize a backend
+Input:    backend
+Returns:  none
+**************************************************************************/
+void disp_init(const disp_ops_t *ops)
+{
+	disp = ops;
+	disp->init();
+}
+
+/*************************************************************************
+Function: disp_adr()
+Purpose:  DDRAM address of a position
+Input:    column 0..19, line 1..4
+Returns:  DDRAM address
+**************************************************************************/
+uint8_t disp_adr(uint8_t col, uint8_t line)
+{
+	return pgm_read_byte(&disp_line[(line-1) & (DISP_LINES-1)]) + col;
+}
+
+/*************************************************************************
+Function: disp_next()
+Purpose:  Next DDRAM address of the auto increment (2 line mode)
+Input:    DDRAM address
+Returns:  next DDRAM address
+**************************************************************************/
+uint8_t disp_next(uint8_t adr)
+{
+	adr++;
+	if (adr == 0x28) adr = 0x40;
+	else if (adr == 0x68) adr = 0x00;
+	return adr;
+}
+
+#ifdef __AVR__
+/*
+** HD44780 4 bit parallel (lcd-routines)
+*/
+static void disp_hd_goto(uint8_t adr)
+{
+	lcd_command(LCD_SET_DDADR | adr);
+}
+
+static void disp_hd_write(const char *data, uint8_t len)
+{
+	while (len--) {
+		lcd_data(*data++);
+	}
+}
+
+static void disp_hd_glyph(uint8_t code, uint8_t row, const uint8_t *data, uint8_t n)
+{
+	lcd_command(LCD_SET_CGADR | (code<<3) | row);
+	while (n--) {
+		lcd_data(*data++);
+	}
+}
+
+const disp_ops_t disp_hd44780 = {
+	lcd_init, disp_hd_goto, disp_hd_write, lcd_clear, disp_hd_glyph
+};
+
+/*
+** PCF8574 I2C expander (i2c_lcd)
+** The address is sent together with the chars in one transaction.
+** A display which does not answer any more is dropped (i2c_dev_ok).
+*/
+static uint8_t disp_pcf_adr;
+static uint8_t disp_pcf_dev = I2C_LCD_DEVICE;
+
+/*************************************************************************
+Function: disp_pcf_address()
+Purpose:  Set the address of the expander, before disp_init()
+Input:    8 bit address, e.g. from i2c_scan_find()
+Returns:  none
+**************************************************************************/
+void disp_pcf_address(uint8_t dev)
+{
+	disp_pcf_dev = dev;
+}
+
+// the bus is set up once by i2c_init(), transactions may be queued
+static void disp_pcf_init(void)
+{
+	i2c_lcd_init(disp_pcf_dev);
+	i2c_lcd_light(true, disp_pcf_dev);
+	disp_pcf_adr = 0;
+}
+
+static void disp_pcf_goto(uint8_t adr)
+{
+	disp_pcf_adr = adr;
+}
+
+static void disp_pcf_write(const char *data, uint8_t len)
+{
+	i2c_lcd_write_run(disp_pcf_adr, data, len, disp_pcf_dev);	// skipped if absent
+	while (len--) {
+		disp_pcf_adr = disp_next(disp_pcf_adr);
+	}
+}
+
+static void disp_pcf_clear(void)
+{
+	if (i2c_dev_ok(disp_pcf_dev)) {
+		i2c_lcd_clear(disp_pcf_dev);
+	}
+	disp_pcf_adr = 0;
+}
+
+static void disp_pcf_glyph(uint8_t code, uint8_t row, const uint8_t *data, uint8_t n)
+{
+	if (!i2c_dev_ok(disp_pcf_dev)) return;
+	i2c_lcd_command(LCD_SET_CGADR | (code<<3) | row, disp_pcf_dev);
+	while (n--) {
+		i2c_lcd_putchar(*data++, disp_pcf_dev);
+	}
+}
+
+const disp_ops_t disp_pcf8574 = {
+	disp_pcf_init, disp_pcf_goto, disp_pcf_write, disp_pcf_clear, disp_pcf_glyph
+};
+#endif
@@ -0,0 +1,105 @@
+/*************************************************************************
+Title:		Display interface
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		disp.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 parallel or over PCF8574
+Description: 	Ops table for the character display
+Usage:
+*************************************************************************/
+
+#ifndef DISP_H
+	#define DISP_H
+
+/**
+ *  @defgroup moe_DISP Display interface
+ *  @code #include <disp.h> @endcode
+ *
+ *  @brief Pluggable backend for HD44780 compatible displays
+ *
+ *	The application uses the display only through the ops table of the
+ *	selected backend:
+ *	- disp_hd44780: 4 bit parallel, lcd-routines
+ *	- disp_pcf8574: PCF8574 I2C expander, i2c_lcd, address I2C_LCD_DEVICE
+ *	  or set by disp_pcf_address()
+ *	- disp_virtual: virtual LCD for the host (disp-virt.c), records
+ *	  bus operations and bus time
+ *
+ *	The cursor is set by the DDRAM address (disp_adr()), a run of chars
+ *	is written with the auto increment of the controller.
+ *	Glyphs are written row by row, so a glyph can be changed partially.
+ *
+ *	@code
+ *	disp_init(&disp_hd44780);
+ *	disp_goto(disp_adr(4, 2));
+ *	disp_write("bar", 3);
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define DISP_COLS			20
+#define DISP_LINES			4
+
+/** @brief Operations of one backend */
+typedef struct {
+	void (*init)(void);									// initialize and clear
+	void (*gotoadr)(uint8_t adr);						// set DDRAM address
+	void (*write)(const char *data, uint8_t len);		// chars at the cursor
+	void (*clear)(void);								// clear, cursor home
+	void (*glyph)(uint8_t code, uint8_t row,			// rows row..row+n-1 of
+				  const uint8_t *data, uint8_t n);		// char 0..7, cursor
+														// undefined after
+} disp_ops_t;
+
+extern const disp_ops_t *disp;			// selected backend
+extern const disp_ops_t disp_hd44780;
+extern const disp_ops_t disp_pcf8574;
+
+/**
+ *	@brief   Select and initialize a backend
+ *
+ *  @param ops	Backend, e.g. &disp_hd44780
+ * 	@return  none
+*/
+void disp_init(const disp_ops_t *ops);
+
+/**
+ *	@brief   DDRAM address of a position
+ *
+ *  @param col	Column 0..19
+ *  @param line	Line 1..4
+ * 	@return  DDRAM address
+*/
+uint8_t disp_adr(uint8_t col, uint8_t line);
+
+/**
+ *	@brief   DDRAM address following adr (0x27 -> 0x40, 0x67 -> 0x00)
+ *
+ *  @param adr	DDRAM address
+ * 	@return  Next DDRAM address of the auto increment
+*/
+uint8_t disp_next(uint8_t adr);
+
+/**
+ *	@brief   Address of the PCF8574 of disp_pcf8574, call before disp_init()
+ *
+ *  @param dev	8 bit address (default I2C_LCD_DEVICE)
+ * 	@return  none
+*/
+void disp_pcf_address(uint8_t dev);
+
+#define disp_goto(__a)			disp->gotoadr(__a)
+#define disp_write(__d,__n)		disp->write(__d, __n)
+#define disp_clear()			disp->clear()
+#define disp_glyph(__c,__r,__d,__n)	disp->glyph(__c, __r, __d, __n)
+
+/**@}*/
+
+#endif
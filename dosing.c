@@ -0,0 +1,181 @@
+/*************************************************************************
+Title:		Dosing
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		dosing.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	ATmega328, flow meter on INT0 (PD2), valve output
+Description:	Flow pulse counting and batches cut off in the ISR
+Usage:		see dosing.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/io.h>
+	#include <avr/interrupt.h>
+	#include "dosing.h"
+
+uint8_t dose_overrun;
+volatile uint16_t dose_flow;
+
+static volatile uint16_t dose_pulses;	// not taken yet
+static volatile uint16_t dose_count;	// pulses of the batch
+static volatile uint16_t dose_cut;		// close the valve at this count
+static volatile uint8_t dose_st;
+static volatile uint8_t dose_hold;		// holdoff ticks left
+static uint16_t dose_target;
+static uint8_t dose_settle;
+static uint8_t dose_done;				// 1 ... dose_res is new
+static dose_result_t dose_res;
+
+#define dose_valve_open()	(DOSE_VALVE_PORT |= (1<<DOSE_VALVE_PIN))
+#define dose_valve_close()	(DOSE_VALVE_PORT &= ~(1<<DOSE_VALVE_PIN))
+
+/*************************************************************************
+Function: dose_init()
+Purpose:  INT0 on falling edges, valve closed
+Input:    none
+Returns:  none
+**************************************************************************/
+void dose_init(void)
+{
+	dose_valve_close();
+	DOSE_VALVE_DDR |= (1<<DOSE_VALVE_PIN);
+	DDRD &= ~(1<<PD2);						// INT0 with pull up
+	PORTD |= (1<<PD2);
+	EICRA = (EICRA & ~((1<<ISC01)|(1<<ISC00))) | (1<<ISC01);	// falling
+	EIFR = (1<<INTF0);
+	EIMSK |= (1<<INT0);
+}
+
+/*************************************************************************
+Function: ISR(INT0_vect)
+Purpose:  Count a pulse, close the valve at the cut count
+**************************************************************************/
+ISR(INT0_vect)
+{
+	EIMSK &= ~(1<<INT0);					// holdoff, see dose_systick()
+	dose_hold = DOSE_HOLDOFF;
+	dose_pulses++;
+	dose_flow++;
+	if (dose_st != DOSE_IDLE) {
+		if (++dose_count >= dose_cut && dose_st == DOSE_RUN) {
+			dose_valve_close();				// no main loop latency
+			dose_st = DOSE_SETTLE_ST;
+		}
+	}
+}
+
+/*************************************************************************
+Function: dose_systick()
+Purpose:  Release the pulse input after the holdoff
+Input:    none
+Returns:  none
+**************************************************************************/
+void dose_systick(void)
+{
+	if (dose_hold && --dose_hold == 0) {
+		EIFR = (1<<INTF0);					// forget the bounces
+		EIMSK |= (1<<INT0);
+	}
+}
+
+/*************************************************************************
+Function: dose_start()
+Purpose:  Start a batch
+Input:    pulses, 0 ... until dose_stop()
+Returns:  1 if started
+**************************************************************************/
+uint8_t dose_start(uint16_t target)
+{
+	if (dose_st != DOSE_IDLE) return 0;
+	dose_target = target;
+	cli();
+	dose_count = 0;
+	if (target == 0) dose_cut = 0xFFFF;		// open until dose_stop()
+	else dose_cut = (target > dose_overrun) ? target - dose_overrun : 1;
+	dose_st = DOSE_RUN;
+	dose_valve_open();
+	sei();
+	dose_res.aborted = 0;
+	dose_res.overrun = target ? target - dose_cut : 0;	// latched, the cut stays
+	return 1;
+}
+
+/*************************************************************************
+Function: dose_stop()
+Purpose:  Close the valve, the batch is aborted
+Input:    none
+Returns:  none
+**************************************************************************/
+void dose_stop(void)
+{
+	cli();
+	dose_valve_close();
+	if (dose_st == DOSE_RUN) {
+		dose_st = DOSE_SETTLE_ST;
+		dose_res.aborted = (dose_target != 0);
+	}
+	sei();
+}
+
+/*************************************************************************
+Function: dose_tick()
+Purpose:  Count the overrun for DOSE_SETTLE, then finish the batch
+Input:    none
+Returns:  none
+**************************************************************************/
+void dose_tick(void)
+{
+	if (dose_st != DOSE_SETTLE_ST) {
+		dose_settle = 0;
+		return;
+	}
+	if (++dose_settle < DOSE_SETTLE) return;
+
+	cli();
+	dose_res.achieved = dose_count;
+	dose_st = DOSE_IDLE;
+	sei();
+	dose_res.requested = dose_target;
+	dose_done = 1;
+}
+
+/*************************************************************************
+Function: dose_state()
+Purpose:  State of the batch
+Input:    none
+Returns:  DOSE_IDLE, DOSE_RUN, DOSE_SETTLE_ST
+**************************************************************************/
+uint8_t dose_state(void)
+{
+	return dose_st;
+}
+
+/*************************************************************************
+Function: dose_take()
+Purpose:  Pulses since the last call
+Input:    none
+Returns:  pulses
+**************************************************************************/
+uint16_t dose_take(void)
+{
+	uint16_t n;
+
+	cli();
+	n = dose_pulses;
+	dose_pulses = 0;
+	sei();
+	return n;
+}
+
+/*************************************************************************
+Function: dose_result()
+Purpose:  Result of the last batch, once
+Input:    destination
+Returns:  1 if a batch was finished
+**************************************************************************/
+uint8_t dose_result(dose_result_t *r)
+{
+	if (!dose_done) return 0;
+	dose_done = 0;
+	*r = dose_res;
+	return 1;
+}
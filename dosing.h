@@ -0,0 +1,138 @@
+/*************************************************************************
+Title:		Dosing
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		dosing.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	ATmega328, flow meter on INT0 (PD2), valve output
+Description: 	Flow pulse counting and batches cut off in the ISR
+Usage:
+*************************************************************************/
+
+#ifndef DOSING_H
+	#define DOSING_H
+
+/**
+ *  @defgroup moe_DOSING Dosing
+ *  @code #include <dosing.h> @endcode
+ *
+ *  @brief Volume batches with the valve closed by the pulse interrupt
+ *
+ *	Every falling edge on INT0 is one flow pulse. After a pulse the
+ *	input is locked for DOSE_HOLDOFF system ticks (contact bounce).
+ *	A batch opens the valve; the INT0 ISR closes it as soon as the
+ *	pulses reach target - overrun, independent of the main loop. The
+ *	pulses after closing (overrun) are counted for DOSE_SETTLE, then
+ *	the batch is done and dose_result() reports the achieved volume.
+ *	The overrun is the flow after closing the valve, it is found from
+ *	achieved - requested of a batch without compensation.
+ *
+ *	@code
+ *	dose_init();
+ *	ISR(TIMER0_COMPA_vect) { dose_systick(); ... }	// system tick
+ *	...
+ *	dose_start(100);						// 100 pulses
+ *	...
+ *	dose_tick();							// every 100ms
+ *	total += dose_take();					// all pulses
+ *	if (dose_result(&r)) ...				// batch done
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define DOSE_VALVE_DDR		DDRD
+#define DOSE_VALVE_PORT		PORTD
+#define DOSE_VALVE_PIN		PD5		// high = open
+#define DOSE_HOLDOFF		10		// system ticks after a pulse (2ms)
+#define DOSE_SETTLE			20		// 100ms ticks of overrun counting
+
+// States
+#define DOSE_IDLE			0
+#define DOSE_RUN			1		// valve open
+#define DOSE_SETTLE_ST		2		// valve closed, overrun counted
+
+/** @brief Result of a batch */
+typedef struct {
+	uint16_t requested;				// pulses, 0 ... timed run
+	uint16_t achieved;				// pulses incl. overrun
+	uint8_t overrun;				// compensation used, set at dose_start()
+	uint8_t aborted;				// 1 ... stopped by dose_stop() before
+									// the target
+} dose_result_t;
+
+extern uint8_t dose_overrun;		// pulses, the valve closes earlier
+extern volatile uint16_t dose_flow;	// all pulses, free running (ISRs)
+
+/**
+ *	@brief   INT0 on falling edges with pull up, valve closed
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void dose_init(void);
+
+/**
+ *	@brief   Release the pulse input after the holdoff, every system tick
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void dose_systick(void);
+
+/**
+ *	@brief   Start a batch, the valve is opened
+ *
+ *  @param target	Pulses, 0 ... open until dose_stop() (timed run)
+ * 	@return  1 if started, 0 if a batch runs
+*/
+uint8_t dose_start(uint16_t target);
+
+/**
+ *	@brief   Close the valve, a batch with a target is reported as aborted
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void dose_stop(void);
+
+/**
+ *	@brief   Count the settle time, call every 100ms
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void dose_tick(void);
+
+/**
+ *	@brief   State of the batch
+ *
+ *	@param   none
+ * 	@return  DOSE_IDLE, DOSE_RUN, DOSE_SETTLE_ST
+*/
+uint8_t dose_state(void);
+
+/**
+ *	@brief   Pulses since the last call, with or without a batch
+ *
+ *	@param   none
+ * 	@return  Pulses
+*/
+uint16_t dose_take(void);
+
+/**
+ *	@brief   Result of the last batch, reported once
+ *
+ *  @param r	Destination
+ * 	@return  1 if a batch was finished since the last call
+*/
+uint8_t dose_result(dose_result_t *r);
+
+/**@}*/
+
+#endif
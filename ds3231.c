@@ -0,0 +1,123 @@
+/*************************************************************************
+Title:		DS3231 RTC
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		ds3231.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR with TWI, DS3231 at I2C address 0x68
+Description:	Read and set the time of a DS3231
+Usage:		see ds3231.h
+*************************************************************************/
+	#include <stdint.h>
+	#include "i2cmaster.h"
+	#include "soft-clock.h"
+	#include "ds3231.h"
+
+#define DS3231_SECONDS		0x00	// first time register
+#define DS3231_STATUS		0x0F
+#define DS3231_OSF			0x80	// oscillator stopped
+#define DS3231_12H			0x40	// hour register: 12h mode
+#ifdef I2C_SCL_400K
+	#define DS3231_SCL		I2C_SCL_400K	// fast mode, the LCD stays at SCL_CLOCK
+#else
+	#define DS3231_SCL		0
+#endif
+
+static uint8_t ds3231_bin(uint8_t bcd)
+{
+	return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+static uint8_t ds3231_bcd(uint8_t bin)
+{
+	return ((bin / 10) << 4) | (bin % 10);
+}
+
+/*************************************************************************
+Function: ds3231_get()
+Purpose:  Read time and date
+Input:    destination, only written with a valid time
+Returns:  I2C_OK, DS3231_INVALID or I2C error
+**************************************************************************/
+static uint8_t ds3231_get(clk_time_t *t)
+{
+	clk_time_t n;
+	uint8_t reg, r[7], st, h;
+
+	reg = DS3231_STATUS;
+	st = i2c_write_then_read(DS3231_ADR, &reg, 1, r, 1);
+	if (st != I2C_OK) return st;
+	if (r[0] & DS3231_OSF) return DS3231_INVALID;
+
+	reg = DS3231_SECONDS;
+	st = i2c_write_then_read(DS3231_ADR, &reg, 1, r, 7);
+	if (st != I2C_OK) return st;
+
+	n.sec = ds3231_bin(r[0] & 0x7F);
+	n.min = ds3231_bin(r[1] & 0x7F);
+	if (r[2] & DS3231_12H) {
+		h = ds3231_bin(r[2] & 0x1F) % 12;	// 12 AM = 0
+		if (r[2] & 0x20) h += 12;			// PM
+	}
+	else {
+		h = ds3231_bin(r[2] & 0x3F);
+	}
+	n.hour = h;
+	n.day = ds3231_bin(r[4] & 0x3F);		// r[3]: day of the week
+	n.month = ds3231_bin(r[5] & 0x1F);		// bit 7: century
+	n.year = ds3231_bin(r[6]);
+
+	// a bad read or a RTC without supply: the tables take no month 0
+	if (n.sec > 59 || n.min > 59 || n.hour > 23 || n.day < 1 || n.day > 31
+		|| n.month < 1 || n.month > 12 || n.year > 99) {
+		return DS3231_INVALID;
+	}
+	*t = n;
+	return I2C_OK;
+}
+
+/*************************************************************************
+Function: ds3231_read()
+Purpose:  Read time and date with DS3231_SCL
+Input:    destination, only written with a valid time
+Returns:  I2C_OK, DS3231_INVALID or I2C error
+**************************************************************************/
+uint8_t ds3231_read(clk_time_t *t)
+{
+	uint8_t st;
+
+	i2c_clock(DS3231_SCL);
+	st = ds3231_get(t);
+	i2c_clock(0);
+	return st;
+}
+
+/*************************************************************************
+Function: ds3231_write()
+Purpose:  Set time and date (24h mode), clear the oscillator stop flag,
+		  with DS3231_SCL
+Input:    time and date
+Returns:  I2C_OK or I2C error
+**************************************************************************/
+uint8_t ds3231_write(const clk_time_t *t)
+{
+	uint8_t w[8], st;
+
+	i2c_clock(DS3231_SCL);
+
+	w[0] = DS3231_SECONDS;
+	w[1] = ds3231_bcd(t->sec);
+	w[2] = ds3231_bcd(t->min);
+	w[3] = ds3231_bcd(t->hour);
+	w[4] = 1;								// day of the week, not used
+	w[5] = ds3231_bcd(t->day);
+	w[6] = ds3231_bcd(t->month);
+	w[7] = ds3231_bcd(t->year);
+	st = i2c_write_buf(DS3231_ADR, w, 8);
+	if (st == I2C_OK) {
+		w[0] = DS3231_STATUS;
+		w[1] = 0;							// clear OSF, 32kHz output off
+		st = i2c_write_buf(DS3231_ADR, w, 2);
+	}
+	i2c_clock(0);
+	return st;
+}
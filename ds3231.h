@@ -0,0 +1,62 @@
+/*************************************************************************
+Title:		DS3231 RTC
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		ds3231.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR with TWI, DS3231 at I2C address 0x68
+Description: 	Read and set the time of a DS3231
+Usage:
+*************************************************************************/
+
+#ifndef DS3231_H
+	#define DS3231_H
+
+/**
+ *  @defgroup moe_DS3231 DS3231 RTC
+ *  @code #include <ds3231.h> @endcode
+ *
+ *  @brief Time and date of a DS3231 over I2C (twimaster)
+ *
+ *	The time registers are read and written in one transaction each,
+ *	with 400kHz (I2C_SCL_400K) if F_CPU allows it. The other devices
+ *	keep SCL_CLOCK, the clock is set back after every access.
+ *	A RTC which lost its supply (oscillator stop flag) reports
+ *	DS3231_INVALID until the time is set, as well as a field out of
+ *	range (e.g. month 0 of a bad read).
+ *
+ *	@code
+ *	clk_time_t t;
+ *	if (ds3231_read(&t) == I2C_OK) clk_sync(&t);
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define DS3231_ADR			0xD0	// 8 bit address
+#define DS3231_INVALID		0x10	// time lost or out of range, besides I2C_xxx
+
+/**
+ *	@brief   Read time and date
+ *
+ *  @param t	Destination, unchanged unless I2C_OK
+ * 	@return  I2C_OK, DS3231_INVALID or the I2C error
+*/
+uint8_t ds3231_read(clk_time_t *t);
+
+/**
+ *	@brief   Set time and date, clears the oscillator stop flag
+ *
+ *  @param t	Time and date (24h)
+ * 	@return  I2C_OK or the I2C error
+*/
+uint8_t ds3231_write(const clk_time_t *t);
+
+/**@}*/
+
+#endif
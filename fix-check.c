@@ -0,0 +1,138 @@
+/*************************************************************************
+Title:		Fixed point format check
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		fix-check.c, v1.0, 2026/10/19
+Software:	gcc on the host
+Hardware: 	none
+Description:	my_fix_str compared with snprintf: all scale/frac/width
+				combinations on selected values, the 16 bit range in the
+				display formats and "%.*f" where the rounding is no tie
+Usage:		gcc -I. -o fix-check fix-check.c my-routines.c num-conv.c
+			./fix-check	(exit code 1 if a text differs)
+*************************************************************************/
+	#include <stdio.h>
+	#include <stdint.h>
+	#include <stdlib.h>
+	#include <string.h>
+	#include "my-routines.h"
+
+#define CHECK_LEN	64
+
+static const int32_t check_val[] = {
+	0, 1, -1, 4, 5, -5, -4, 9, 10, 15, 25, 49, -49, 50, -50, 99, 100, 999,
+	1000, 12345, -12345, 994999, 995000, 25806528, 50000148, 99999999,
+	999999999, 1000000000, 2147483647, -2147483647, INT32_MIN
+};
+
+// formats of the display: scale, frac, width
+static const uint8_t check_fmt[][3] = {
+	{ 7, 1, 4 }, { 3, 3, 6 }, { 2, 1, 0 }, { 0, 0, 5 }, { 1, 2, 0 }
+};
+
+static long check_n, check_bad;
+
+/*************************************************************************
+Function: check_ref()
+Purpose:  Reference text with snprintf on the integer and fraction part,
+		  rounded half away from zero, no "-0"
+Input:    destination, value, scale, frac, width
+Returns:  none
+**************************************************************************/
+static void check_ref(char *dst, int32_t value, int scale, int frac, int width)
+{
+	long long n = (value < 0) ? -(long long)value : value;
+	long long p = 1;
+	int neg = (value < 0);
+	char t[CHECK_LEN];
+	int i;
+
+	if (frac < scale) {				// round at the last printed digit
+		for (i = 0; i < scale - frac; i++) p *= 10;
+		n = (n + p/2) / p;
+	}
+	else {							// append zeros
+		for (i = 0; i < frac - scale; i++) n *= 10;
+	}
+	if (n == 0) neg = 0;
+	for (p = 1, i = 0; i < frac; i++) p *= 10;
+	if (frac)
+		snprintf(t, sizeof(t), "%s%lld.%0*lld", neg ? "-" : "", n / p, frac, n % p);
+	else
+		snprintf(t, sizeof(t), "%s%lld", neg ? "-" : "", n);
+	snprintf(dst, CHECK_LEN, "%*s", width, t);
+}
+
+/*************************************************************************
+Function: check_one()
+Purpose:  Compare my_fix_str with the reference
+Input:    value, scale, frac, width
+Returns:  none
+**************************************************************************/
+static void check_one(int32_t value, uint8_t scale, uint8_t frac, uint8_t width)
+{
+	char ref[CHECK_LEN], got[CHECK_LEN];
+
+	check_ref(ref, value, scale, frac, width);
+	my_fix_str(got, sizeof(got), value, scale, frac, width);
+	check_n++;
+	if (strcmp(ref, got) != 0) {
+		if (++check_bad < 20)
+			printf("  %ld scale %u frac %u width %u: [%s] expected [%s]\n",
+				   (long)value, scale, frac, width, got, ref);
+	}
+}
+
+int main(void)
+{
+	char ref[CHECK_LEN], got[CHECK_LEN];
+	uint8_t scale, frac, width, k;
+	int32_t v;
+	long fbad = 0, q;
+	unsigned i;
+	int r;
+
+	// every format on the selected and on pseudo random values
+	srand(1);
+	for (scale = 0; scale <= 9; scale++)
+		for (frac = 0; frac <= 9; frac++)
+			for (width = 0; width <= 14; width += 7) {
+				for (i = 0; i < sizeof(check_val)/sizeof(check_val[0]); i++)
+					check_one(check_val[i], scale, frac, width);
+				for (r = 0; r < 3000; r++) {
+					v = (int32_t)((uint32_t)rand() * 2654435761u ^ (uint32_t)rand());
+					if (r < 1000) v %= 100000;
+					check_one(v, scale, frac, width);
+				}
+			}
+
+	// display formats on the whole 16 bit range and some more
+	for (v = -70000; v <= 70000; v++)
+		for (k = 0; k < sizeof(check_fmt)/sizeof(check_fmt[0]); k++)
+			check_one(v, check_fmt[k][0], check_fmt[k][1], check_fmt[k][2]);
+
+	// snprintf("%.*f") itself, ties skipped (binary float, round to even)
+	for (v = -200000; v <= 200000; v++) {
+		for (frac = 0; frac <= 3; frac++) {
+			for (q = 1, k = frac; k < 3; k++) q *= 10;
+			if (q > 1 && (labs(v) % q) * 2 == q) continue;
+			snprintf(ref, sizeof(ref), "%.*f", frac, v / 1000.0);
+			if (ref[0] == '-' && strspn(ref + 1, "0.") == strlen(ref + 1))
+				memmove(ref, ref + 1, strlen(ref));		// no "-0.0"
+			my_fix_str(got, sizeof(got), v, 3, frac, 0);
+			check_n++;
+			if (strcmp(ref, got) != 0 && ++fbad < 20)
+				printf("  %ld frac %u: [%s] snprintf [%s]\n", (long)v, frac, got, ref);
+		}
+	}
+
+	// cut off at the size, the length of the complete text is returned
+	r = my_fix_str(got, 5, -123456, 2, 2, 0);
+	check_n++;
+	if (r != 8 || strcmp(got, "-123") != 0) {
+		printf("  cut off: %d [%s] expected 8 [-123]\n", r, got);
+		check_bad++;
+	}
+
+	printf("%ld texts, %ld differ\n", check_n, check_bad + fbad);
+	return (check_bad + fbad) ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+/*************************************************************************
+Title:		I2C bus scan
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		i2c-scan.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR with TWI, twimaster
+Description:	Find the devices on the I2C bus at boot and while running
+Usage:		see i2c-scan.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/pgmspace.h>
+	#include "i2cmaster.h"
+	#include "i2c-scan.h"
+
+uint8_t i2c_scan_map[16];
+
+// Known devices: first and last 7 bit address, type
+static const uint8_t i2c_scan_tab[][3] PROGMEM = {
+	{ 0x20, 0x27, I2C_SCAN_LCD },		// PCF8574
+	{ 0x28, 0x28, I2C_SCAN_PRESSURE },	// Honeywell HSC/SSC
+	{ 0x38, 0x3F, I2C_SCAN_LCD },		// PCF8574A
+	{ 0x50, 0x57, I2C_SCAN_EEPROM },	// 24LCxx
+	{ 0x68, 0x68, I2C_SCAN_RTC },		// DS1307, DS3231
+	{ 0x76, 0x77, I2C_SCAN_PRESSURE },	// BMP280, BME280
+};
+#define I2C_SCAN_TAB	(sizeof(i2c_scan_tab) / sizeof(i2c_scan_tab[0]))
+
+static i2c_xfer_t i2c_scan_x;			// probe of i2c_scan_step()
+static uint8_t i2c_scan_adr = I2C_SCAN_FIRST;
+
+/*************************************************************************
+Function: i2c_scan_set()
+Purpose:  Store the result of a probe
+Input:    7 bit address, 1 = answered
+Returns:  1 if the result changed
+**************************************************************************/
+static uint8_t i2c_scan_set(uint8_t addr, uint8_t found)
+{
+	uint8_t *p = &i2c_scan_map[addr >> 3];
+	uint8_t m = 1 << (addr & 7);
+	uint8_t old = (*p & m) != 0;
+
+	if (found) *p |= m;
+	else *p &= ~m;
+	return old != found;
+}
+
+/*************************************************************************
+Function: i2c_scan()
+Purpose:  Probe all addresses
+Input:    none
+Returns:  number of devices
+**************************************************************************/
+uint8_t i2c_scan(void)
+{
+	uint8_t addr, n;
+
+	n = 0;
+	for (addr = I2C_SCAN_FIRST; addr <= I2C_SCAN_LAST; addr++) {
+		if (i2c_write_buf(addr << 1, 0, 0) == I2C_OK) {
+			i2c_scan_set(addr, 1);
+			n++;
+		}
+		else {
+			i2c_scan_set(addr, 0);
+		}
+	}
+	return n;
+}
+
+/*************************************************************************
+Function: i2c_scan_step()
+Purpose:  Take the result of the last probe and queue the next one
+Input:    none
+Returns:  1 if a device appeared or vanished
+**************************************************************************/
+uint8_t i2c_scan_step(void)
+{
+	uint8_t changed = 0;
+
+	if (i2c_scan_x.status & I2C_PENDING) {
+		return 0;						// probe still running
+	}
+	if (i2c_scan_x.addr) {
+		changed = i2c_scan_set(i2c_scan_adr, i2c_scan_x.status == I2C_OK);
+		if (++i2c_scan_adr > I2C_SCAN_LAST) {
+			i2c_scan_adr = I2C_SCAN_FIRST;
+		}
+	}
+	i2c_scan_x.addr = i2c_scan_adr << 1;
+	i2c_scan_x.wlen = 0;
+	i2c_scan_x.rlen = 0;
+	if (i2c_submit(&i2c_scan_x)) {		// queue full: same address next time
+		i2c_scan_x.addr = 0;			// no result to take
+	}
+	return changed;
+}
+
+/*************************************************************************
+Function: i2c_scan_type()
+Purpose:  Type of an address
+Input:    7 bit address
+Returns:  I2C_SCAN_LCD ... or I2C_SCAN_UNKNOWN
+**************************************************************************/
+uint8_t i2c_scan_type(uint8_t addr)
+{
+	uint8_t i;
+
+	for (i = 0; i < I2C_SCAN_TAB; i++) {
+		if (addr >= pgm_read_byte(&i2c_scan_tab[i][0]) &&
+			addr <= pgm_read_byte(&i2c_scan_tab[i][1])) {
+			return pgm_read_byte(&i2c_scan_tab[i][2]);
+		}
+	}
+	return I2C_SCAN_UNKNOWN;
+}
+
+/*************************************************************************
+Function: i2c_scan_find()
+Purpose:  First device of a type
+Input:    type
+Returns:  8 bit address or 0
+**************************************************************************/
+uint8_t i2c_scan_find(uint8_t type)
+{
+	uint8_t addr;
+
+	for (addr = I2C_SCAN_FIRST; addr <= I2C_SCAN_LAST; addr++) {
+		if ((i2c_scan_map[addr >> 3] & (1 << (addr & 7))) &&
+			i2c_scan_type(addr) == type) {
+			return addr << 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*************************************************************************
+Title:		I2C bus scan
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		i2c-scan.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR with TWI, twimaster
+Description: 	Find the devices on the I2C bus at boot and while running
+Usage:
+*************************************************************************/
+
+#ifndef I2C_SCAN_H
+	#define I2C_SCAN_H
+
+/**
+ *  @defgroup moe_I2C_SCAN I2C bus scan
+ *  @code #include <i2c-scan.h> @endcode
+ *
+ *  @brief Enumeration of the I2C bus and detection of known devices
+ *
+ *	Every 7 bit address 0x08..0x77 is probed with an empty write
+ *	(address only). The probes go through the transaction queue, so
+ *	they are bounded by the timeouts of twimaster.
+ *	- i2c_scan(): complete scan at boot (about 40ms at 100kHz)
+ *	- i2c_scan_step(): one probe per call in the background, a device
+ *	  which appears or vanishes is reported, e.g. to bind a hot-plugged
+ *	  LCD
+ *	The type of a device is taken from a table of address ranges, the
+ *	first device of a type is returned by i2c_scan_find().
+ *
+ *	@code
+ *	i2c_init();
+ *	i2c_scan();
+ *	lcd = i2c_scan_find(I2C_SCAN_LCD);		// 8 bit address or 0
+ *	...
+ *	if (i2c_scan_step()) rebind();			// every 100ms
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define I2C_SCAN_FIRST		0x08	// 7 bit addresses, reserved ones skipped
+#define I2C_SCAN_LAST		0x77
+
+// Device types
+#define I2C_SCAN_UNKNOWN	0
+#define I2C_SCAN_LCD		1		// PCF8574 / PCF8574A LCD backpack
+#define I2C_SCAN_EEPROM		2		// 24LCxx
+#define I2C_SCAN_RTC		3		// DS1307 / DS3231
+#define I2C_SCAN_PRESSURE	4		// HSC/SSC (0x28), BMP/BME280 (0x76)
+
+extern uint8_t i2c_scan_map[16];	// one bit per 7 bit address, 1 = answered
+
+/**
+ *	@brief   Probe all addresses (blocking)
+ *
+ *	@param   none
+ * 	@return  Number of devices found
+*/
+uint8_t i2c_scan(void);
+
+/**
+ *	@brief   Probe the next address in the background
+ *
+ *	The probe is queued, its result is taken at the next call.
+ *
+ *	@param   none
+ * 	@return  1 if a device appeared or vanished, else 0
+*/
+uint8_t i2c_scan_step(void);
+
+/**
+ *	@brief   Type of an address from the table of known devices
+ *
+ *  @param addr	7 bit address
+ * 	@return  I2C_SCAN_LCD ... or I2C_SCAN_UNKNOWN
+*/
+uint8_t i2c_scan_type(uint8_t addr);
+
+/**
+ *	@brief   First device of a type which answered
+ *
+ *  @param type	I2C_SCAN_LCD ...
+ * 	@return  8 bit address (Dev_ID of i2c_lcd, i2cmaster) or 0
+*/
+uint8_t i2c_scan_find(uint8_t type);
+
+/**@}*/
+
+#endif
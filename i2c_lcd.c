@@ -43,12 +43,38 @@
 // global variable fr light control
 
 static uint8_t lightOn=0;
-
+
+// Queued transaction of i2c_lcd_write_run(): address and chars, 4 bytes each
+static uint8_t i2c_lcd_run_buf[4 * (I2C_LCD_RUN_MAX + 1)];
+static i2c_xfer_t i2c_lcd_run_x;
+
+// 4-bit-Mode configuration, sent by i2c_lcd_init()
+static const uint8_t i2c_lcd_init_cmds[] = {
+	I2C_LCD_LINE_MODE | I2C_LCD_5X7,
+	I2C_LCD_DISPLAYON | I2C_LCD_CURSOROFF | I2C_LCD_BLINKINGOFF,
+	I2C_LCD_CLEAR,
+	I2C_LCD_INCREASE | I2C_LCD_DISPLAYSHIFTOFF
+};
+
+//-	Wait for the end of clear/home (1.52ms)
+// With I2C_LCD_BUSY_POLL the busy flag is read instead, one poll takes
+// 6 short transactions (about 0.5ms at 100kHz)
+
+static void i2c_lcd_wait_long(uint8_t Dev_ID) {
+#if I2C_LCD_BUSY_POLL
+	uint8_t n = I2C_LCD_BUSY_TIMEOUT;
+
+	while (i2c_lcd_busy(Dev_ID) && --n);
+#else
+	_delay_ms(2);
+#endif
+}
+
 //-	Display initialization sequence
 
 void i2c_lcd_clear(uint8_t Dev_ID) {
 	i2c_lcd_command(I2C_LCD_CLEAR, Dev_ID);
-	_delay_ms(2);
+	i2c_lcd_wait_long(Dev_ID);
 }
 
 
@@ -64,26 +90,19 @@ void i2c_lcd_init(uint8_t Dev_ID) {
 	i2c_lcd_write(CMD_D1 | CMD_D0, Dev_ID);	//-	Set interface to 8-bit
 	i2c_lcd_write(CMD_D1, Dev_ID);		    //-	Set interface to 4-bit
 
-	//- From now on in 4-bit-Mode
-	i2c_lcd_command(I2C_LCD_LINE_MODE | I2C_LCD_5X7, Dev_ID);
-	i2c_lcd_command(I2C_LCD_DISPLAYON | I2C_LCD_CURSOROFF | I2C_LCD_BLINKINGOFF, Dev_ID);
-	i2c_lcd_command(I2C_LCD_CLEAR, Dev_ID);
-    _delay_ms(2);
-	i2c_lcd_command(I2C_LCD_INCREASE | I2C_LCD_DISPLAYSHIFTOFF, Dev_ID);
+	//- From now on in 4-bit-Mode, all commands in one burst
+	i2c_lcd_commands(i2c_lcd_init_cmds, sizeof(i2c_lcd_init_cmds), Dev_ID);
 }
 
 //-	Write data to i2c
 
 void i2c_lcd_write_i2c(uint8_t value, uint8_t Dev_ID) {
-	i2c_start_wait(Dev_ID+I2C_WRITE);
-	i2c_write(value);
-	i2c_stop();
+	i2c_write_buf(Dev_ID, &value, 1);
 }
 
-//-	Write nibble to display with pulse of enable bit
-// map pinout between PCF8574 and LCD
+//-	Map nibble and RS/RW to the pinout of the PCF8574
 
-void i2c_lcd_write(uint8_t value, uint8_t Dev_ID) {
+static uint8_t i2c_lcd_map(uint8_t value) {
     uint8_t data_out=0;
     
     // map data to LCD pinout
@@ -94,19 +113,59 @@ void i2c_lcd_write(uint8_t value, uint8_t Dev_ID) {
     if (value & CMD_RS) data_out |= I2C_LCD_RS;
     if (value & CMD_RW) data_out |= I2C_LCD_RW;
     if (!lightOn) data_out |= I2C_LCD_LIGHT_N;
+    return data_out;
+}
+
+//-	Write nibble inside an open i2c transaction
+// The PCF8574 changes its outputs after every byte, so enable high and
+// enable low are just two bytes of the same transaction
+
+static void i2c_lcd_burst_nibble(uint8_t value) {
+    uint8_t data_out = i2c_lcd_map(value);
+
+	i2c_write(data_out | I2C_LCD_E);	//-	Set new data and enable to high
+	i2c_write(data_out);				//-	Set enable to low
+}
+
+//-	Write byte inside an open i2c transaction (rs = CMD_RS for data)
+// 4 bytes at 100kHz take longer than the execution time of the LCD
+
+static void i2c_lcd_burst_byte(uint8_t value, uint8_t rs) {
+
+	i2c_lcd_burst_nibble((value >> 4) | rs);
+	i2c_lcd_burst_nibble((value & 0x0F) | rs);
+}
+
+//-	Put byte into a buffer for a queued transaction, returns the end
+
+static uint8_t *i2c_lcd_fill_byte(uint8_t *p, uint8_t value, uint8_t rs) {
+	uint8_t data_out;
 
-	i2c_lcd_write_i2c(data_out | I2C_LCD_E, Dev_ID);		//-	Set new data and enable to high
-	i2c_lcd_write_i2c(data_out, Dev_ID);	            //-	Set enable to low
+	data_out = i2c_lcd_map((value >> 4) | rs);
+	*p++ = data_out | I2C_LCD_E;
+	*p++ = data_out;
+	data_out = i2c_lcd_map((value & 0x0F) | rs);
+	*p++ = data_out | I2C_LCD_E;
+	*p++ = data_out;
+	return p;
+}
+
+//-	Write nibble to display with pulse of enable bit
+
+void i2c_lcd_write(uint8_t value, uint8_t Dev_ID) {
+	uint8_t buf[2];
+
+	buf[1] = i2c_lcd_map(value);
+	buf[0] = buf[1] | I2C_LCD_E;		//-	Set new data and enable to high, then low
+	i2c_write_buf(Dev_ID, buf, 2);
 }
 
 //-	Read data from i2c
 
 uint8_t i2c_lcd_read_i2c(uint8_t Dev_ID) {
-	uint8_t lcddata = 0x00;
+	uint8_t lcddata;
 
-	i2c_start_wait(Dev_ID+I2C_READ);
-	lcddata = i2c_readNak();
-	i2c_stop();
+	if (i2c_read_buf(Dev_ID, &lcddata, 1) != I2C_OK) return 0xFF;	//- no answer: busy
 	return lcddata;
 }
 
@@ -152,18 +211,72 @@ uint8_t i2c_lcd_getbyte(bool mode, uint8_t Dev_ID)  {
 //-	Issue a command to the display (use the defined commands above)
 
 void i2c_lcd_command(uint8_t command, uint8_t Dev_ID) {
+	uint8_t buf[4];
+
+	i2c_lcd_fill_byte(buf, command, 0);
+	i2c_write_buf(Dev_ID, buf, 4);
+}
+
+//-	Issue a sequence of commands in one i2c transaction
+// Clear and home need 1.52ms, the transaction is split after them
 
-    i2c_lcd_write((command >> 4), Dev_ID);
-	i2c_lcd_write((command & 0x0F), Dev_ID);	
+void i2c_lcd_commands(const uint8_t *commands, uint8_t len, uint8_t Dev_ID) {
+	uint8_t command;
+
+	if (i2c_start_wait(Dev_ID+I2C_WRITE)) return;
+	while (len--) {
+		command = *commands++;
+		i2c_lcd_burst_byte(command, 0);
+		if (command < I2C_LCD_ENTRYMODE) {		// clear or home
+			i2c_stop();
+			i2c_lcd_wait_long(Dev_ID);
+			if (!len || i2c_start_wait(Dev_ID+I2C_WRITE)) return;
+		}
+	}
+	i2c_stop();
+}
+
+//-	Write len chars at DDRAM address adr in one queued i2c transaction
+// The TWI interrupt sends the run while the caller goes on. A longer run
+// is split, the address of the next part wraps like the address counter
+// of the display (0x27 -> 0x40, 0x67 -> 0x00). Nothing is sent while the
+// LCD is dropped by its failed accesses (i2c_dev_ok), a run to a missing
+// LCD would wait for the NACK retries and the i2c_tick() timeout.
+
+void i2c_lcd_write_run(uint8_t adr, const char *data, uint8_t len, uint8_t Dev_ID) {
+	uint8_t *p;
+	uint8_t n;
+
+	while (len) {
+		n = (len > I2C_LCD_RUN_MAX) ? I2C_LCD_RUN_MAX : len;
+		len -= n;
+		while (i2c_lcd_run_x.status & I2C_PENDING) i2c_poll();	//- buffer still in use
+		if (!i2c_dev_ok(Dev_ID)) return;	//- absent, also after the last part failed
+
+		p = i2c_lcd_fill_byte(i2c_lcd_run_buf, 0x80 | adr, 0);
+		while (n--) {
+			p = i2c_lcd_fill_byte(p, *data++, CMD_RS);
+			adr++;
+			if (adr == 0x28) adr = 0x40;
+			else if (adr == 0x68) adr = 0x00;
+		}
+		i2c_lcd_run_x.addr = Dev_ID;
+		i2c_lcd_run_x.wbuf = i2c_lcd_run_buf;
+		i2c_lcd_run_x.wlen = p - i2c_lcd_run_buf;
+		i2c_lcd_run_x.rlen = 0;
+		while (i2c_submit(&i2c_lcd_run_x)) i2c_poll();
+	}
 }
 
 //-	Print string to cursor position
 
 void i2c_lcd_print(char *string, uint8_t Dev_ID) {
 
+	if (i2c_start_wait(Dev_ID+I2C_WRITE)) return;
 	while(*string)	{
-		i2c_lcd_putchar(*string++, Dev_ID);
+		i2c_lcd_burst_byte(*string++, CMD_RS);
 	}
+	i2c_stop();
 }
 
 //-	Print string from flash to cursor position
@@ -171,17 +284,20 @@ void i2c_lcd_print(char *string, uint8_t Dev_ID) {
 void i2c_lcd_print_P(PGM_P string, uint8_t Dev_ID) {
     uint8_t c;
 
+	if (i2c_start_wait(Dev_ID+I2C_WRITE)) return;
 	while((c=pgm_read_byte(string++)))	{
-		i2c_lcd_putchar(c, Dev_ID);
+		i2c_lcd_burst_byte(c, CMD_RS);
 	}
+	i2c_stop();
 }
 
 //-	Put char to atctual cursor position
 
 void i2c_lcd_putchar(char lcddata, uint8_t Dev_ID) {
+	uint8_t buf[4];
 
-	i2c_lcd_write((lcddata >> 4) | CMD_RS, Dev_ID);
-	i2c_lcd_write((lcddata & 0x0F) | CMD_RS, Dev_ID);
+	i2c_lcd_fill_byte(buf, lcddata, CMD_RS);
+	i2c_write_buf(Dev_ID, buf, 4);
 }
 
 //-	Put char to position
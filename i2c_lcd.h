@@ -132,6 +132,11 @@ int main(void)
 #define I2C_LCD_LINES			4	        /**< Enter the number of lines of your display here */
 #define I2C_LCD_COLS			20	        /**< Enter the number of columns of your display here */
 #define I2C_LCD_LINE_MODE       I2C_LCD_2LINE   /**< Enter line mode your display here */
+#ifndef I2C_LCD_BUSY_POLL
+#define I2C_LCD_BUSY_POLL		0			/**< 1: read the busy flag after clear/home instead of waiting 2ms */
+#endif
+#define I2C_LCD_BUSY_TIMEOUT	10			/**< Maximum number of busy flag polls */
+#define I2C_LCD_RUN_MAX			20			/**< Chars per queued transaction of i2c_lcd_write_run() */
 
 #define I2C_LCD_LINE1			0x00	    /**< This should be 0x00 on all displays */
 #define I2C_LCD_LINE2			0x40	    /**< Change this to the address for line 2 on your display */
@@ -335,6 +340,28 @@ void i2c_lcd_init(uint8_t Dev_ID);
  */
 void i2c_lcd_command(uint8_t command, uint8_t Dev_ID);
 
+/**
+ \brief Issue a sequence of commands in one i2c transaction
+ \param *commands pointer to the commands
+ \param len number of commands
+ \param Dev_ID Device number of i2c-Display
+ \return none
+ */
+void i2c_lcd_commands(const uint8_t *commands, uint8_t len, uint8_t Dev_ID);
+
+/**
+ \brief Set the DDRAM address and write chars in one i2c transaction
+ The transaction is queued (i2c_submit) and sent by the TWI interrupt,
+ the function only waits if the previous run is not sent yet. Nothing
+ is sent while i2c_dev_ok(Dev_ID) is false.
+ \param adr DDRAM address (e.g. I2C_LCD_LINE2 + col - 1)
+ \param *data pointer to the chars, not terminated
+ \param len number of chars
+ \param Dev_ID Device number of i2c-Display
+ \return none
+ */
+void i2c_lcd_write_run(uint8_t adr, const char *data, uint8_t len, uint8_t Dev_ID);
+
 /**
  \brief Go to position
  \param line 1st line is 1 and last line = LCD_LINES
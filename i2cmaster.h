@@ -93,14 +93,55 @@
 /** defines the data direction (writing to I2C device) in i2c_start(),i2c_rep_start() */
 #define I2C_WRITE   0
 
+#ifndef I2C_TIMEOUT_US
+#define I2C_TIMEOUT_US  1000      /**< max. time of one byte, then the bus is cleared */
+#endif
+#ifndef I2C_START_TRIES
+#define I2C_START_TRIES 50        /**< ack polling of i2c_start_wait(), 50 = 5ms at 100kHz */
+#endif
+#ifndef I2C_RETRIES
+#define I2C_RETRIES     3         /**< address NACKs of a queued transaction */
+#endif
+#ifndef I2C_STOP_US
+#define I2C_STOP_US     20        /**< STOP wait in the ISR, 2 SCL periods at 100kHz */
+#endif
+#ifndef I2C_RETRY_US
+#define I2C_RETRY_US    5000      /**< retry delay of i2c_poll(), EEPROM write cycle */
+#endif
+#define I2C_DEV_MAX     8         /**< devices with error counters */
+
+/**
+ @brief TWBR for a SCL frequency with prescaler 1, for i2c_clock() and
+ i2c_xfer_t.twbr. SCL = F_CPU/(16+2*TWBR), e.g. 400kHz at 16MHz: TWBR = 12.
+ */
+#define I2C_SCL(hz)     ((F_CPU/(hz) - 16) / 2)
+#define I2C_SCL_TWBR_MIN 10       /**< smallest TWBR for a stable master */
+/* only defined if the clock is possible with F_CPU */
+#if I2C_SCL(100000UL) <= 255
+#define I2C_SCL_100K    I2C_SCL(100000UL)   /**< standard mode */
+#endif
+#if F_CPU/400000UL >= 16 + 2*I2C_SCL_TWBR_MIN
+#define I2C_SCL_400K    I2C_SCL(400000UL)   /**< fast mode, e.g. FRAM, sensors */
+#endif
+#define I2C_DEV_FAIL    5         /**< failed accesses in a row until a device is dropped */
+
 
 /**
  @brief initialize the I2C master interace. Need to be called only once 
+ The bus runs with SCL_CLOCK (default 100kHz), prescaler and bit rate are
+ computed at compile time.
  @param  void
  @return none
  */
 extern void i2c_init(void);
 
+/**
+ @brief Clock of the following blocking transfers, set at i2c_start()
+ @param  twbr I2C_SCL_400K, I2C_SCL(hz) or 0 for SCL_CLOCK
+ @return none
+ */
+extern void i2c_clock(unsigned char twbr);
+
 
 /** 
  @brief Terminates the data transfer and releases the I2C bus 
@@ -133,11 +174,13 @@ extern unsigned char i2c_rep_start(unsigned char addr);
 /**
  @brief Issues a start condition and sends address and transfer direction 
    
- If device is busy, use ack polling to wait until device ready 
+ If device is busy, use ack polling to wait until device ready,
+ at most I2C_START_TRIES times
  @param    addr address and transfer direction of I2C device
- @return   none
+ @retval   0 device accessible
+ @retval   1 failed to access device, the bus is released
  */
-extern void i2c_start_wait(unsigned char addr);
+extern unsigned char i2c_start_wait(unsigned char addr);
 
  
 /**
@@ -161,6 +204,35 @@ extern unsigned char i2c_readAck(void);
  */
 extern unsigned char i2c_readNak(void);
 
+/**
+ @brief    Bus clear: up to 9 clocks on SCL until SDA is released, then STOP
+ Called automatically after a timeout.
+ @param    void
+ @return   none
+ */
+extern void i2c_recover(void);
+
+/** @brief number of bus clears since start */
+extern volatile uint16_t i2c_recoveries;
+
+/**
+ @brief    Failed accesses of a device since start (NACK, timeout, bus error)
+ @param    addr address of the device
+ @return   number of errors
+ */
+extern uint16_t i2c_dev_errors(unsigned char addr);
+
+/**
+ @brief    Device is usable
+ Higher layers skip a device after I2C_DEV_FAIL failed accesses in a row,
+ e.g. the LCD is dropped and the metering goes on. The next access which
+ is answered (e.g. the probe of the bus scan) makes it usable again.
+ @param    addr address of the device
+ @retval   1 device answered recently or was never used
+ @retval   0 device dropped
+ */
+extern unsigned char i2c_dev_ok(unsigned char addr);
+
 /** 
  @brief    read one byte from the I2C device
  
@@ -174,5 +246,130 @@ extern unsigned char i2c_read(unsigned char ack);
 #define i2c_read(ack)  (ack) ? i2c_readAck() : i2c_readNak(); 
 
 
+/**
+ @name Interrupt driven transactions
+ A transaction (write phase, repeated start, read phase) is described by
+ an i2c_xfer_t and queued with i2c_submit(). TWI_vect runs it byte by byte,
+ so the CPU only spends a few us per byte. The blocking functions above
+ wait until the queue is empty and hold the bus from i2c_start() to
+ i2c_stop(), queued transactions are started after i2c_stop().
+ A busy device (address NACK) is tried I2C_RETRIES times, each retry is
+ started by the next i2c_tick() (I2C_RETRY_US later in i2c_poll()), so
+ the retries span more than the 5ms write cycle of an EEPROM. i2c_tick()
+ aborts a transaction which hangs. The ISRs wait I2C_STOP_US at most,
+ the bus clear of a hanging bus (some 100us) is done by i2c_poll() from
+ the main loop, the queue is held until then.
+ @code
+ static uint8_t reg = 0x00, val[2];
+ static i2c_xfer_t x = { 0xD0, &reg, 1, val, 2, 0, NULL };
+ i2c_submit(&x);                  // returns at once
+ ...
+ if (x.status == I2C_OK) ...      // or a callback in x.done
+ @endcode
+*/
+/**@{*/
+#ifndef I2C_QUEUE_SIZE
+#define I2C_QUEUE_SIZE  4         /**< queued transactions + 1 */
+#endif
+
+#define I2C_OK          0         /**< transaction done */
+#define I2C_NACK        1         /**< address or data not acknowledged */
+#define I2C_ERROR       2         /**< bus error or arbitration lost */
+#define I2C_TIMEOUT     3         /**< no progress, bus cleared */
+#define I2C_PENDING     0x80      /**< queued, bit set while not done */
+#define I2C_BUSY        0x81      /**< running */
+
+/** @brief transaction descriptor, must stay valid until it is done */
+typedef struct i2c_xfer {
+    uint8_t addr;                 /**< device address (8 bit, R/W bit ignored) */
+    const uint8_t *wbuf;          /**< bytes of the write phase */
+    uint8_t wlen;                 /**< 0: no write phase */
+    uint8_t *rbuf;                /**< buffer of the read phase */
+    uint8_t rlen;                 /**< 0: no read phase, both 0: probe */
+    volatile uint8_t status;      /**< I2C_PENDING, I2C_BUSY, I2C_OK ... */
+    void (*done)(struct i2c_xfer *x);   /**< called from the ISR or NULL */
+    uint8_t twbr;                 /**< clock, I2C_SCL_400K or 0 for SCL_CLOCK */
+} i2c_xfer_t;
+
+/**
+ @brief    Queue a transaction, started at once if the bus is free
+ @param    x transaction
+ @retval   0 queued
+ @retval   1 queue full
+ */
+extern unsigned char i2c_submit(i2c_xfer_t *x);
+
+/**
+ @brief    Queue a transaction and wait until it is done (blocking wrapper)
+ @param    x transaction
+ @return   I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+ */
+extern unsigned char i2c_transfer(i2c_xfer_t *x);
+
+/**
+ @brief    Clear the bus after an abort, call from the main loop (not from
+ an ISR). Runs the transactions while interrupts are disabled.
+ @param    void
+ @return   none
+ */
+extern void i2c_poll(void);
+
+/**
+ @brief    Supervision, call every 100ms, e.g. from a timer ISR
+ Restarts a transaction after an address NACK. A queued transaction
+ without progress for 2 calls is aborted with I2C_TIMEOUT, the bus is
+ cleared by the next i2c_poll().
+ @param    void
+ @return   none
+ */
+extern void i2c_tick(void);
+/**@}*/
+
+
+/**
+ @name Buffer transfers
+ Blocking transactions through the queue with one status for all bytes.
+ Not to be called between i2c_start() and i2c_stop(). The clock is set
+ by i2c_clock().
+ @code
+ uint8_t reg = 0x00, t[7];
+ if (i2c_write_then_read(0xD0, &reg, 1, t, 7) == I2C_OK) ...   // RTC registers 0..6
+ uint8_t page[1+8] = { 0x10, 1, 2, 3, 4, 5, 6, 7, 8 };
+ i2c_write_buf(0xA0, page, sizeof(page));                      // EEPROM page write
+ @endcode
+*/
+/**@{*/
+/**
+ @brief    Write len bytes in one transaction
+ @param    addr device address
+ @param    data bytes
+ @param    len number of bytes, 0 = address probe
+ @return   I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+ */
+extern unsigned char i2c_write_buf(unsigned char addr, const uint8_t *data, uint8_t len);
+
+/**
+ @brief    Read len bytes in one transaction, the last byte is NACKed
+ @param    addr device address
+ @param    data buffer
+ @param    len number of bytes, > 0
+ @return   I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+ */
+extern unsigned char i2c_read_buf(unsigned char addr, uint8_t *data, uint8_t len);
+
+/**
+ @brief    Write bytes, repeated start and read bytes in one transaction
+ @param    addr device address
+ @param    wdata bytes to write, e.g. a register address
+ @param    wlen number of bytes to write
+ @param    rdata buffer
+ @param    rlen number of bytes to read
+ @return   I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+ */
+extern unsigned char i2c_write_then_read(unsigned char addr, const uint8_t *wdata, uint8_t wlen,
+                                         uint8_t *rdata, uint8_t rlen);
+/**@}*/
+
+
 /**@}*/
 #endif
@@ -0,0 +1,161 @@
+/*************************************************************************
+Title:		Key debouncing
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		key-debounce.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, keys and contacts against GND
+Description:	Debouncing of up to 16 inputs on two ports with repeat
+Usage:		see key-debounce.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/io.h>
+	#include <avr/interrupt.h>
+	#include "key-debounce.h"
+
+volatile uint16_t key_state;
+volatile uint16_t key_press;
+volatile uint16_t key_rpt;
+
+static uint16_t key_rpt_mask;				// inputs with repeat
+static uint8_t key_rpt_start[KEY_MAX];		// ticks until the first repeat
+static uint8_t key_rpt_next[KEY_MAX];		// ticks between repeats
+static uint8_t key_rpt_ct[KEY_MAX];			// ticks until the next repeat
+
+/*************************************************************************
+Function: key_init()
+Purpose:  Inputs with pull up, no repeat
+Input:    none
+Returns:  none
+**************************************************************************/
+void key_init(void)
+{
+	KEY_LO_DDR &= ~KEY_LO_MASK;				// input
+	KEY_LO_PORT |= KEY_LO_MASK;				// pull up
+	KEY_HI_DDR &= ~KEY_HI_MASK;
+	KEY_HI_PORT |= KEY_HI_MASK;
+	key_rpt_mask = 0;
+}
+
+/*************************************************************************
+Function: key_repeat()
+Purpose:  Set the repeat of inputs
+Input:    inputs, ticks until the first repeat (0 = off), ticks between
+Returns:  none
+**************************************************************************/
+void key_repeat(uint16_t mask, uint8_t start, uint8_t next)
+{
+	uint8_t n;
+
+	cli();
+	for (n = 0; n < KEY_MAX; n++) {
+		if (mask & (1U << n)) {
+			key_rpt_start[n] = start;
+			key_rpt_next[n] = next;
+			key_rpt_ct[n] = start;
+		}
+	}
+	if (start) key_rpt_mask |= mask;
+	else key_rpt_mask &= ~mask;
+	sei();
+}
+
+/*************************************************************************
+Function: key_tick()
+Purpose:  Sample and debounce all inputs
+Input:    none
+Returns:  none
+**************************************************************************/
+void key_tick(void)
+{
+	static uint16_t ct0 = 0xFFFF, ct1 = 0xFFFF;
+	uint16_t i, held, m;
+	uint8_t n;
+
+	i = (uint16_t)(uint8_t)~KEY_HI_PIN << 8 | (uint8_t)~KEY_LO_PIN;
+	i = key_state ^ (i & KEY_ALL);			// key changed ?
+	ct0 = ~(ct0 & i);						// reset or count ct0
+	ct1 = ct0 ^ (ct1 & i);					// reset or count ct1
+	i &= ct0 & ct1;							// count until roll over ?
+	key_state ^= i;							// then toggle debounced state
+	key_press |= key_state & i;				// 0->1: key press detect
+
+	held = key_state & key_rpt_mask;		// only held repeat inputs
+	for (n = 0, m = 1; held; n++, m <<= 1) {
+		if (!(held & m)) continue;
+		held &= ~m;
+		if (i & m) {
+			key_rpt_ct[n] = key_rpt_start[n];	// pressed: start delay
+		}
+		else if (--key_rpt_ct[n] == 0) {
+			key_rpt_ct[n] = key_rpt_next[n];	// repeat delay
+			key_rpt |= m;
+		}
+	}
+}
+
+/*************************************************************************
+Function: get_key_press()
+Purpose:  Presses of the inputs, each press is reported once
+Input:    inputs
+Returns:  inputs pressed
+**************************************************************************/
+uint16_t get_key_press(uint16_t key_mask)
+{
+	cli();									// read and clear atomic !
+	key_mask &= key_press;
+	key_press ^= key_mask;
+	sei();
+	return key_mask;
+}
+
+/*************************************************************************
+Function: get_key_rpt()
+Purpose:  Repeats of held inputs
+Input:    inputs
+Returns:  inputs repeated
+**************************************************************************/
+uint16_t get_key_rpt(uint16_t key_mask)
+{
+	cli();									// read and clear atomic !
+	key_mask &= key_rpt;
+	key_rpt ^= key_mask;
+	sei();
+	return key_mask;
+}
+
+/*************************************************************************
+Function: get_key_state()
+Purpose:  Inputs pressed right now
+Input:    inputs
+Returns:  inputs pressed
+**************************************************************************/
+uint16_t get_key_state(uint16_t key_mask)
+{
+	cli();									// 16 bit read atomic
+	key_mask &= key_state;
+	sei();
+	return key_mask;
+}
+
+/*************************************************************************
+Function: get_key_short()
+Purpose:  Presses released before the first repeat
+Input:    inputs
+Returns:  inputs
+**************************************************************************/
+uint16_t get_key_short(uint16_t key_mask)
+{
+	cli();									// read key state and key press atomic !
+	return get_key_press(~key_state & key_mask);
+}
+
+/*************************************************************************
+Function: get_key_long()
+Purpose:  Presses held until the first repeat
+Input:    inputs
+Returns:  inputs
+**************************************************************************/
+uint16_t get_key_long(uint16_t key_mask)
+{
+	return get_key_press(get_key_rpt(key_mask));
+}
@@ -0,0 +1,139 @@
+/*************************************************************************
+Title:		Key debouncing
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		key-debounce.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, keys and contacts against GND
+Description: 	Debouncing of up to 16 inputs on two ports with repeat
+Usage:
+*************************************************************************/
+
+#ifndef KEY_DEBOUNCE_H
+	#define KEY_DEBOUNCE_H
+
+/**
+ *  @defgroup moe_KEY_DEBOUNCE Key debouncing
+ *  @code #include <key-debounce.h> @endcode
+ *
+ *  @brief Vertical counter debouncing of 16 inputs (P. Dannegger)
+ *
+ *	The inputs are bit 0..7 of the low port and bit 8..15 of the high
+ *	port, both ports are sampled in one go. Every input has a 2 bit
+ *	counter, the bits of all counters are kept in two words (vertical
+ *	counter): an input is taken after 4 equal samples, the cost of
+ *	key_tick() does not depend on the number of inputs.
+ *	Repeat start and rate are set per input with key_repeat(), only the
+ *	held repeat inputs are counted.
+ *	Input numbers: KEY_LO(bit) on the low port, KEY_HI(bit) on the high
+ *	port, the masks are 1<<number.
+ *
+ *	@code
+ *	key_init();
+ *	key_repeat(1<<KEY1, 50, 20);	// after 500ms, every 200ms
+ *	...
+ *	key_tick();						// every 10ms from the system tick
+ *	...
+ *	if (get_key_short(1<<KEY2)) ...
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define KEY_LO_PORT		PORTD	// inputs 0..7
+#define KEY_LO_DDR		DDRD
+#define KEY_LO_PIN		PIND
+#define KEY_HI_PORT		PORTC	// inputs 8..15
+#define KEY_HI_DDR		DDRC
+#define KEY_HI_PIN		PINC
+
+#define KEY_LO(__b)		(__b)
+#define KEY_HI(__b)		((__b) + 8)
+#define KEY_MAX			16
+
+// Inputs of WaterControl, PD2 (SW1) is the flow input INT0 of dosing.c
+#define KEY1			KEY_LO(PD3)		// menu
+#define KEY2			KEY_HI(PC3)
+#define KEY_ALL			(1U<<KEY1 | 1U<<KEY2)
+
+#define KEY_LO_MASK		((uint8_t)(KEY_ALL))
+#define KEY_HI_MASK		((uint8_t)((KEY_ALL) >> 8))
+
+extern volatile uint16_t key_state;		// debounced state, 1 = pressed
+extern volatile uint16_t key_press;		// press detected
+extern volatile uint16_t key_rpt;		// long press and repeat
+
+/**
+ *	@brief   Inputs with pull up, no repeat
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void key_init(void);
+
+/**
+ *	@brief   Set the repeat of inputs
+ *
+ *  @param mask		Inputs
+ *  @param start	Ticks until the first repeat (long press), 0 = no repeat
+ *  @param next		Ticks between the following repeats
+ * 	@return  none
+*/
+void key_repeat(uint16_t mask, uint8_t start, uint8_t next);
+
+/**
+ *	@brief   Sample and debounce all inputs, call from the timer ISR
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void key_tick(void);
+
+/**
+ *	@brief   Presses of the inputs, each press is reported once
+ *
+ *  @param key_mask	Inputs
+ * 	@return  Inputs pressed since the last call
+*/
+uint16_t get_key_press(uint16_t key_mask);
+
+/**
+ *	@brief   Repeats of held inputs, like repeated presses
+ *
+ *  @param key_mask	Inputs
+ * 	@return  Inputs repeated since the last call
+*/
+uint16_t get_key_rpt(uint16_t key_mask);
+
+/**
+ *	@brief   Inputs pressed right now (debounced)
+ *
+ *  @param key_mask	Inputs
+ * 	@return  Inputs pressed
+*/
+uint16_t get_key_state(uint16_t key_mask);
+
+/**
+ *	@brief   Presses released before the first repeat
+ *
+ *  @param key_mask	Inputs
+ * 	@return  Inputs
+*/
+uint16_t get_key_short(uint16_t key_mask);
+
+/**
+ *	@brief   Presses held until the first repeat
+ *
+ *  @param key_mask	Inputs
+ * 	@return  Inputs
+*/
+uint16_t get_key_long(uint16_t key_mask);
+
+/**@}*/
+
+#endif
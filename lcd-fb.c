@@ -0,0 +1,209 @@
+/*************************************************************************
+Title:		LCD framebuffer
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		lcd-fb.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 4x20 via disp
+Description:	Shadow buffer of the LCD, only changed chars are sent
+Usage:		see lcd-fb.h
+*************************************************************************/
+	#include <stdint.h>
+	#include "lcd-fb.h"
+	#include "disp.h"
+#ifdef __AVR__
+	#include <avr/pgmspace.h>
+#else
+	// host build with disp-virt.c
+	#define PROGMEM
+	#define pgm_read_byte(p)	(*(p))
+#endif
+
+#define LCD_FB_NO_CURSOR	0xFF	// cursor position of the display unknown
+
+// Buffer in DDRAM order: line 1 (0x00), 3 (0x14), 2 (0x40), 4 (0x54)
+static char lcd_fb_buf[LCD_FB_SIZE];
+static uint8_t lcd_fb_dirty[LCD_FB_SIZE/8];	// one bit per cell
+static uint8_t lcd_fb_cur;						// index of the display cursor
+
+// Index of column 0 for line 1..4
+static const uint8_t lcd_fb_line[LCD_FB_LINES] PROGMEM = {
+	0, 2*LCD_FB_COLS, LCD_FB_COLS, 3*LCD_FB_COLS
+};
+
+/*************************************************************************
+Function: lcd_fb_set()
+Purpose:  Write one cell and mark it dirty if changed
+Input:    index, character
+Returns:  none
+**************************************************************************/
+static void lcd_fb_set(uint8_t i, char c)
+{
+	if (lcd_fb_buf[i] != c) {
+		lcd_fb_buf[i] = c;
+		lcd_fb_dirty[i>>3] |= (1 << (i & 7));
+	}
+}
+
+/*************************************************************************
+Function: lcd_fb_init()
+Purpose:  Initialize the framebuffer for a cleared display
+Input:    none
+Returns:  none
+**************************************************************************/
+void lcd_fb_init(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < LCD_FB_SIZE; i++) {
+		lcd_fb_buf[i] = ' ';
+	}
+	for (i = 0; i < LCD_FB_SIZE/8; i++) {
+		lcd_fb_dirty[i] = 0;
+	}
+	lcd_fb_cur = LCD_FB_NO_CURSOR;
+}
+
+/*************************************************************************
+Function: lcd_fb_putc()
+Purpose:  Put one char into the buffer
+Input:    character, column 0..19, line 1..4
+Returns:  none
+**************************************************************************/
+void lcd_fb_putc(char c, uint8_t col, uint8_t line)
+{
+	if ((col >= LCD_FB_COLS) || (line < 1) || (line > LCD_FB_LINES)) return;
+	lcd_fb_set(pgm_read_byte(&lcd_fb_line[line-1]) + col, c);
+}
+
+/*************************************************************************
+Function: lcd_fb_string()
+Purpose:  Put a string into the buffer
+Input:    string, column 0..19, line 1..4
+Returns:  none
+**************************************************************************/
+void lcd_fb_string(const char *data, uint8_t col, uint8_t line)
+{
+	uint8_t i;
+
+	if ((line < 1) || (line > LCD_FB_LINES)) return;
+	i = pgm_read_byte(&lcd_fb_line[line-1]) + col;
+	while (*data && (col++ < LCD_FB_COLS)) {
+		lcd_fb_set(i++, *data++);
+	}
+}
+
+/*************************************************************************
+Function: lcd_fb_string_p()
+Purpose:  Put a string from flash into the buffer
+Input:    string in program memory, column 0..19, line 1..4
+Returns:  none
+**************************************************************************/
+void lcd_fb_string_p(const char *data, uint8_t col, uint8_t line)
+{
+	uint8_t i;
+	char c;
+
+	if ((line < 1) || (line > LCD_FB_LINES)) return;
+	i = pgm_read_byte(&lcd_fb_line[line-1]) + col;
+	while ((c = pgm_read_byte(data++)) && (col++ < LCD_FB_COLS)) {
+		lcd_fb_set(i++, c);
+	}
+}
+
+/*************************************************************************
+Function: lcd_fb_clear()
+Purpose:  Fill the buffer with spaces
+Input:    none
+Returns:  none
+**************************************************************************/
+void lcd_fb_clear(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < LCD_FB_SIZE; i++) {
+		lcd_fb_set(i, ' ');
+	}
+}
+
+/*************************************************************************
+Function: lcd_fb_invalidate()
+Purpose:  Mark all cells dirty, cursor of the display unknown
+Input:    none
+Returns:  none
+**************************************************************************/
+void lcd_fb_invalidate(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < LCD_FB_SIZE/8; i++) {
+		lcd_fb_dirty[i] = 0xFF;
+	}
+	lcd_fb_cur = LCD_FB_NO_CURSOR;
+}
+
+/*************************************************************************
+Function: lcd_fb_run()
+Purpose:  Send a run of cells to the display
+Input:    index of the first cell, number of cells
+Returns:  number of bus operations
+**************************************************************************/
+static uint8_t lcd_fb_run(uint8_t i, uint8_t n)
+{
+	uint8_t end = i + n;
+	uint8_t ops = n;
+
+	// Set the cursor only if the auto increment does not fit
+	if (i != lcd_fb_cur) {
+		disp_goto((i < 2*LCD_FB_COLS) ? i : i - 2*LCD_FB_COLS + 0x40);
+		ops++;
+	}
+	disp_write(&lcd_fb_buf[i], n);
+	// DDRAM 0x27 -> 0x40 and 0x67 -> 0x00 like the buffer
+	lcd_fb_cur = (end == LCD_FB_SIZE) ? 0 : end;
+	return ops;
+}
+
+/*************************************************************************
+Function: lcd_fb_glyph()
+Purpose:  Write rows of a glyph, the cursor of the display is lost
+Input:    code 0..7, first row, rows, number of rows
+Returns:  none
+**************************************************************************/
+void lcd_fb_glyph(uint8_t code, uint8_t row, const uint8_t *data, uint8_t n)
+{
+	disp_glyph(code, row, data, n);
+	lcd_fb_cur = LCD_FB_NO_CURSOR;
+}
+
+/*************************************************************************
+Function: lcd_fb_flush()
+Purpose:  Send the dirty cells to the display
+Input:    none
+Returns:  number of bus operations
+**************************************************************************/
+uint8_t lcd_fb_flush(void)
+{
+	uint8_t i = 0, n;
+	uint8_t ops = 0;
+
+	while (i < LCD_FB_SIZE) {
+		if (lcd_fb_dirty[i>>3] == 0) {		// 8 clean cells
+			i = (i | 7) + 1;
+			continue;
+		}
+		// Collect a run of dirty cells
+		n = 0;
+		while ((i+n < LCD_FB_SIZE) && (lcd_fb_dirty[(i+n)>>3] & (1 << ((i+n) & 7)))) {
+			lcd_fb_dirty[(i+n)>>3] &= ~(1 << ((i+n) & 7));
+			n++;
+		}
+		if (n) {
+			ops += lcd_fb_run(i, n);
+			i += n;
+		}
+		else {
+			i++;
+		}
+	}
+	return ops;
+}
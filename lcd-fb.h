@@ -0,0 +1,137 @@
+/*************************************************************************
+Title:		LCD framebuffer
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		lcd-fb.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 4x20 via disp
+Description: 	Shadow buffer of the LCD, only changed chars are sent
+Usage:
+*************************************************************************/
+
+#ifndef LCD_FB_H
+	#define LCD_FB_H
+
+/**
+ *  @defgroup moe_LCD_FB LCD framebuffer
+ *  @code #include <lcd-fb.h> @endcode
+ *
+ *  @brief Shadow buffer for a 4x20 LCD with dirty-cell diffing
+ *
+ *	All text is written into a shadow buffer in SRAM. A char which
+ *	differs from the buffer marks its cell dirty, lcd_fb_flush() sends
+ *	only the dirty cells to the display.
+ *	The buffer is ordered like the DDRAM of the HD44780
+ *	(line 1, line 3, line 2, line 4), so a run of dirty cells is
+ *	written with the auto increment of the display and the cursor is
+ *	only set in front of a run.
+ *
+ *	The display is written through the selected backend of disp.h.
+ *
+ *	@code
+ *	disp_init(&disp_hd44780);
+ *	lcd_fb_init();
+ *	lcd_fb_string("bar", 4, 2);
+ *	...
+ *	lcd_fb_string(adc_eval, 0, 2);		// only the changed digits
+ *	lcd_fb_flush();						// are sent to the display
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define LCD_FB_COLS			20
+#define LCD_FB_LINES		4
+#define LCD_FB_SIZE			(LCD_FB_COLS * LCD_FB_LINES)
+
+/**
+ *	@brief   Initialize the framebuffer
+ *
+ *	The display has to be cleared before (disp_init() or disp_clear()),
+ *	the buffer is set to spaces without any dirty cell.
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void lcd_fb_init(void);
+
+/**
+ *	@brief   Put one char into the buffer
+ *
+ *  @param c	Character
+ *  @param col	Column 0..19
+ *  @param line	Line 1..4
+ * 	@return  none
+*/
+void lcd_fb_putc(char c, uint8_t col, uint8_t line);
+
+/**
+ *	@brief   Put a string into the buffer, cut off at the end of the line
+ *
+ *  @param data	String
+ *  @param col	Column 0..19
+ *  @param line	Line 1..4
+ * 	@return  none
+*/
+void lcd_fb_string(const char *data, uint8_t col, uint8_t line);
+
+/**
+ *	@brief   Put a string from flash into the buffer
+ *	@see lcd_fb_string
+*/
+void lcd_fb_string_p(const char *data, uint8_t col, uint8_t line);
+
+/**
+ * @brief    Macro to automatically put a string constant into program memory
+ */
+#define lcd_fb_string_P(__s,__c,__l)	lcd_fb_string_p(PSTR(__s), __c, __l)
+
+/**
+ *	@brief   Fill the buffer with spaces
+ *
+ *	Only the cells which are not blank yet become dirty.
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void lcd_fb_clear(void);
+
+/**
+ *	@brief   Mark all cells dirty
+ *
+ *	Call after the display was written or reset without the buffer.
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void lcd_fb_invalidate(void);
+
+/**
+ *	@brief   Write rows of a glyph (CGRAM) through the display backend
+ *
+ *	Cells showing the glyph change without rewriting the cells.
+ *
+ *  @param code	Char code 0..7 (shown with code or code+8)
+ *  @param row	First row 0..7
+ *  @param data	Rows, 5 bits each
+ *  @param n	Number of rows
+ * 	@return  none
+*/
+void lcd_fb_glyph(uint8_t code, uint8_t row, const uint8_t *data, uint8_t n);
+
+/**
+ *	@brief   Send all dirty cells to the display
+ *
+ *	@param   none
+ * 	@return  Number of bus operations (chars and cursor commands)
+*/
+uint8_t lcd_fb_flush(void);
+
+/**@}*/
+
+#endif
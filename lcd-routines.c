@@ -21,11 +21,36 @@ Usage:			AREF - Voltage reference for adc: 1->5V ; 0->2,56V
 // http://www.mikrocontroller.net/articles/AVR-GCC-Tutorial/LCD-Ansteuerung
 //
 // Die Pinbelegung ist ber defines in lcd-routines.h einstellbar
+//
+// Nach lcd_init() werden Befehle und Daten nur in eine Queue geschrieben.
+// lcd_tick() (vom System-Tick alle LCD_TICK_US) gibt jeweils ein Byte aus und
+// hlt die Ausfhrungszeiten des HD44780 durch Auslassen von Ticks ein.
+// Mit LCD_RW wird statt dessen das Busy-Flag gelesen und ausgegeben,
+// sobald der Controller bereit ist (hchstens LCD_BUSY_TIMEOUT_US).
  
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include "lcd-routines.h"
+#include "num-conv.h"
 #include <util/delay.h>
  
+#define LCD_Q_RS        0x01    // Datenbyte (RS=1)
+#define LCD_Q_LONG      0x02    // Clear/Home: lange Ausfhrungszeit
+#define LCD_Q_MASK      (LCD_QUEUE_SIZE-1)
+
+#if (LCD_QUEUE_SIZE & LCD_Q_MASK)
+    #error "LCD_QUEUE_SIZE must be a power of 2"
+#endif
+
+static volatile uint8_t lcd_q_data[LCD_QUEUE_SIZE];
+static volatile uint8_t lcd_q_flag[LCD_QUEUE_SIZE];
+static volatile uint8_t lcd_q_head;     // nchster freier Eintrag
+static volatile uint8_t lcd_q_tail;     // nchster auszugebender Eintrag
+static volatile uint8_t lcd_q_wait;     // Ticks bis zur nchsten Ausgabe
+                                        // bzw. bis zum Timeout des Busy-Flags
+
+static void lcd_out( uint8_t data );
+
 ////////////////////////////////////////////////////////////////////////////////
 // Erzeugt einen Enable-Puls
 static void lcd_enable( void )
@@ -46,10 +71,111 @@ static void lcd_out( uint8_t data )
     lcd_enable();
 }
  
+#ifdef LCD_RW
+////////////////////////////////////////////////////////////////////////////////
+// Liest das Busy-Flag (DB7), beide Nibble mssen gelesen werden
+static uint8_t lcd_read_busy( void )
+{
+    uint8_t bf;
+
+    LCD_DDR &= ~(0x0F<<LCD_DB);         // Datenleitungen auf Eingang
+    LCD_PORT &= ~((0x0F<<LCD_DB) | (1<<LCD_RS));
+    LCD_RW_PORT |= (1<<LCD_RW);         // Lesen, RS=0: Busy-Flag/Adresse
+
+    LCD_PORT |= (1<<LCD_EN);
+    _delay_us( LCD_ENABLE_US );         // Daten gltig nach 360ns
+    bf = LCD_PIN & (1<<(LCD_DB+3));     // oberes Nibble, DB7 = Busy-Flag
+    LCD_PORT &= ~(1<<LCD_EN);
+    lcd_enable();                       // unteres Nibble verwerfen
+
+    LCD_RW_PORT &= ~(1<<LCD_RW);        // zurck auf Schreiben
+    LCD_DDR |= (0x0F<<LCD_DB);
+    return bf;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Gibt den nchsten Eintrag der Queue aus, aufgerufen jeden Tick
+static void lcd_q_step( void )
+{
+    uint8_t t;
+
+#ifdef LCD_RW
+    if ( lcd_q_wait ) {                 // Befehl wird noch ausgefhrt
+        if ( lcd_read_busy() ) {
+            lcd_q_wait--;               // bei Timeout trotzdem weiter
+            return;
+        }
+        lcd_q_wait = 0;
+    }
+#else
+    if ( lcd_q_wait ) {                 // Befehl wird noch ausgefhrt
+        lcd_q_wait--;
+        return;
+    }
+#endif
+    t = lcd_q_tail;
+    if ( t == lcd_q_head )              // Queue leer
+        return;
+
+    if ( lcd_q_flag[t] & LCD_Q_RS )
+        LCD_PORT |= (1<<LCD_RS);
+    else
+        LCD_PORT &= ~(1<<LCD_RS);
+    lcd_out( lcd_q_data[t] );           // zuerst die oberen,
+    lcd_out( lcd_q_data[t]<<4 );        // dann die unteren 4 Bit senden
+
+#ifdef LCD_RW
+    // Ab dem nchsten Tick das Busy-Flag lesen
+    lcd_q_wait = LCD_BUSY_TIMEOUT_US / LCD_TICK_US;
+#else
+    // Daten/Befehle sind nach einem Tick fertig, Clear/Home nach 2ms
+    if ( lcd_q_flag[t] & LCD_Q_LONG )
+        lcd_q_wait = (LCD_CLEAR_DISPLAY_MS*1000UL + LCD_TICK_US-1) / LCD_TICK_US;
+#endif
+    lcd_q_tail = (t+1) & LCD_Q_MASK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Tick der Queue, alle LCD_TICK_US aus der ISR des System-Ticks aufrufen
+void lcd_tick( void )
+{
+    lcd_q_step();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Schreibt einen Eintrag in die Queue und startet den Tick
+static void lcd_put( uint8_t data, uint8_t flag )
+{
+    uint8_t next = (lcd_q_head+1) & LCD_Q_MASK;
+
+    // Queue voll: warten bis die ISR Platz gemacht hat, bei gesperrten
+    // Interrupts den Tick selbst abarbeiten
+    while ( next == lcd_q_tail ) {
+        if ( !(SREG & (1<<SREG_I)) ) {
+            _delay_us( LCD_TICK_US );
+            lcd_q_step();
+        }
+    }
+    lcd_q_data[lcd_q_head] = data;
+    lcd_q_flag[lcd_q_head] = flag;
+    lcd_q_head = next;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Liefert 1 solange die Queue noch nicht ausgegeben ist
+uint8_t lcd_busy( void )
+{
+    return ( lcd_q_head != lcd_q_tail ) || lcd_q_wait;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Initialisierung: muss ganz am Anfang des Programms aufgerufen werden.
 void lcd_init( void )
 {
+    // Queue leeren, lcd_tick() gibt whrend der Initialisierung nichts aus
+    lcd_q_head = lcd_q_tail = lcd_q_wait = 0;
+
     // verwendete Pins auf Ausgang schalten
     uint8_t pins = (0x0F << LCD_DB) |           // 4 Datenleitungen
                    (1<<LCD_RS) |                // R/S Leitung
@@ -58,6 +184,10 @@ void lcd_init( void )
  
     // initial alle Ausgnge auf Null
     LCD_PORT &= ~pins;
+#ifdef LCD_RW
+    LCD_RW_DDR |= (1<<LCD_RW);                  // R/W Leitung, 0=Schreiben
+    LCD_RW_PORT &= ~(1<<LCD_RW);
+#endif
  
     // warten auf die Bereitschaft des LCD
     _delay_ms( LCD_BOOTUP_MS );
@@ -77,6 +207,8 @@ void lcd_init( void )
              LCD_FUNCTION_4BIT );
     _delay_ms( LCD_SET_4BITMODE_MS );
  
+    // ab hier nur noch ber die Queue, keine Wartezeiten mehr
+ 
     // 4-bit Modus / 2 Zeilen / 5x7
     lcd_command( LCD_SET_FUNCTION |
                  LCD_FUNCTION_4BIT |
@@ -101,40 +233,28 @@ void lcd_init( void )
 // Sendet ein Datenbyte an das LCD
 void lcd_data( uint8_t data )
 {
-    LCD_PORT |= (1<<LCD_RS);    // RS auf 1 setzen
- 
-    lcd_out( data );            // zuerst die oberen, 
-    lcd_out( data<<4 );         // dann die unteren 4 Bit senden
- 
-    _delay_us( LCD_WRITEDATA_US );
+    lcd_put( data, LCD_Q_RS );
 }
  
 ////////////////////////////////////////////////////////////////////////////////
 // Sendet einen Befehl an das LCD
 void lcd_command( uint8_t data )
 {
-    LCD_PORT &= ~(1<<LCD_RS);    // RS auf 0 setzen
- 
-    lcd_out( data );             // zuerst die oberen, 
-    lcd_out( data<<4 );           // dann die unteren 4 Bit senden
- 
-    _delay_us( LCD_COMMAND_US );
+    lcd_put( data, 0 );
 }
  
 ////////////////////////////////////////////////////////////////////////////////
 // Sendet den Befehl zur Lschung des Displays
 void lcd_clear( void )
 {
-    lcd_command( LCD_CLEAR_DISPLAY );
-    _delay_ms( LCD_CLEAR_DISPLAY_MS );
+    lcd_put( LCD_CLEAR_DISPLAY, LCD_Q_LONG );
 }
  
 ////////////////////////////////////////////////////////////////////////////////
 // Sendet den Befehl: Cursor Home
 void lcd_home( void )
 {
-    lcd_command( LCD_CURSOR_HOME );
-    _delay_ms( LCD_CURSOR_HOME_MS );
+    lcd_put( LCD_CURSOR_HOME, LCD_Q_LONG );
 }
  
 ////////////////////////////////////////////////////////////////////////////////
@@ -207,14 +327,15 @@ void lcd_generatechar( uint8_t code, const uint8_t *data )
 //////////////////////////////////////////////////////////////////////////////// 
 ////////////////////////////////////////////////////////////////////////////////
 // Schreibt ???
-unsigned long tenths_tab[10] = {1000000000,100000000,10000000,1000000,100000,10000,1000,100,10,1};
 char long2ascii(char *target, unsigned long value)
 {
   unsigned char p, pos=0;
   unsigned char numbernow=0;
   char ret=0;
+  unsigned long p10;
   
   for (p=0;(p<10) && (pos<5);p++) {
+    p10 = num_pow10(9-p);        // Zehnerpotenz aus dem Flash
     
     if (numbernow) {
       // Eventually place dot
@@ -231,7 +352,7 @@ char long2ascii(char *target, unsigned long value)
       }      
     }
     
-    if (value < tenths_tab[p]) {
+    if (value < p10) {
       if (numbernow) {
         // Inside number, put a zero
         target[pos] = '0';  
@@ -253,9 +374,9 @@ char long2ascii(char *target, unsigned long value)
     } 
     else {
       target[pos] = '0';
-      while (value >= tenths_tab[p]) {
+      while (value >= p10) {
         target[pos]++;
-        value -= tenths_tab[p];
+        value -= p10;
       }
       pos++;
       numbernow = 1;
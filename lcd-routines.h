@@ -64,11 +64,19 @@ Usage:		see Doxygen manual
 //  LCD EN      <-->  PORTD Bit PB1     (EN: 1-Impuls fr Daten)
 #define LCD_EN        PB1
  
+//  LCD RW      <-->  PORTD Bit PD4     (RW: 1=Lesen, optional)
+//  Nur wenn RW angeschlossen ist (sonst RW auf GND): das Busy-Flag wird
+//  abgefragt statt die maximalen Ausfhrungszeiten abzuwarten
+//#define LCD_RW_PORT   PORTD
+//#define LCD_RW_DDR    DDRD
+//#define LCD_RW        PD4
+#define LCD_PIN       PINB
+ 
 ////////////////////////////////////////////////////////////////////////////////
 // LCD Ausfhrungszeiten (MS=Millisekunden, US=Mikrosekunden)
  
 #define LCD_BOOTUP_MS           15
-#define LCD_ENABLE_US           20
+#define LCD_ENABLE_US           1       // min. 450ns, wird auch in der ISR gewartet
 #define LCD_WRITEDATA_US        46
 #define LCD_COMMAND_US          42
  
@@ -79,6 +87,32 @@ Usage:		see Doxygen manual
  
 #define LCD_CLEAR_DISPLAY_MS    2
 #define LCD_CURSOR_HOME_MS      2
+
+////////////////////////////////////////////////////////////////////////////////
+// Queue fr die Ausgabe im Hintergrund (lcd_tick() vom System-Tick)
+
+// Abstand der Aufrufe von lcd_tick(): ohne RW >= LCD_WRITEDATA_US, mit RW
+// kurz, damit das Busy-Flag bald nach dem Ende des Befehls gesehen wird
+#ifndef LCD_TICK_US
+  #ifdef LCD_RW
+    #define LCD_TICK_US         20      // Abfrage des Busy-Flags
+  #else
+    #define LCD_TICK_US         50      // Abstand zweier Ausgaben
+  #endif
+#endif
+#ifdef LCD_RW
+    #define LCD_BUSY_TIMEOUT_US 4000    // danach wird trotzdem ausgegeben
+#endif
+#ifndef LCD_QUEUE_SIZE
+    #define LCD_QUEUE_SIZE      32      // Eintrge, Zweierpotenz
+#endif
+
+#if !defined(LCD_RW) && ((LCD_TICK_US < LCD_WRITEDATA_US) || (LCD_TICK_US < LCD_COMMAND_US))
+    #error "LCD_TICK_US is shorter than the execution time of the LCD"
+#endif
+#if defined(LCD_RW) && (LCD_BUSY_TIMEOUT_US / LCD_TICK_US > 255)
+    #error "LCD_BUSY_TIMEOUT_US too long for LCD_TICK_US"
+#endif
  
 ////////////////////////////////////////////////////////////////////////////////
 // Zeilendefinitionen des verwendeten LCD
@@ -237,6 +271,29 @@ void lcd_generatechar( uint8_t code, const uint8_t *data );
 */
 void lcd_command( uint8_t data );
 
+/**
+ *	@brief   Check if the LCD queue is written
+ *
+ *	lcd_data(), lcd_command(), lcd_clear() etc. only write into the queue
+ *	and return immediately (unless the queue is full). lcd_tick() sends
+ *	one entry every LCD_TICK_US.
+ *	
+ *	@param   none 
+ * 	@return  1 while entries are pending, 0 if the LCD is idle
+*/
+uint8_t lcd_busy( void );
+
+/**
+ *	@brief   Send the next entry of the queue
+ *
+ *	Call every LCD_TICK_US from the ISR of the system tick, also before
+ *	lcd_init().
+ *	
+ *	@param   none 
+ * 	@return  none
+*/
+void lcd_tick( void );
+
 /**
  *	@brief   Convert a long integer to a char
  *	
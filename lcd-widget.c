@@ -0,0 +1,173 @@
+/*************************************************************************
+Title:		LCD widgets
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		lcd-widget.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 4x20 via disp
+Description:	Bar graphs and sparklines from the CGRAM glyphs
+Usage:		see lcd-widget.h
+*************************************************************************/
+	#include <stdint.h>
+	#include "lcd-fb.h"
+	#include "lcd-widget.h"
+
+#define LCD_WG_CODE(__g)	((__g) + 8)		// char code of a glyph, not '\0'
+#define LCD_WG_PIXELS		5				// columns of a cell
+
+/*************************************************************************
+Function: lcd_wg_scale()
+Purpose:  Scale a value to pixels
+Input:    value, full scale value, pixels of the full scale
+Returns:  pixels 0..full
+**************************************************************************/
+static uint8_t lcd_wg_scale(uint16_t value, uint16_t max, uint8_t full)
+{
+	if (max == 0 || value >= max) {
+		return full;
+	}
+	return ((uint32_t)value * full + max/2) / max;
+}
+
+/*************************************************************************
+Function: lcd_wg_init()
+Purpose:  Define the bar glyphs 1..4 columns
+Input:    none
+Returns:  none
+**************************************************************************/
+void lcd_wg_init(void)
+{
+	uint8_t rows[LCD_WG_ROWS];
+	uint8_t i, r, bits;
+
+	bits = 0;
+	for (i = 0; i < LCD_WG_PIXELS-1; i++) {
+		bits |= 0x10 >> i;
+		for (r = 0; r < LCD_WG_ROWS; r++) {
+			rows[r] = bits;
+		}
+		lcd_fb_glyph(LCD_WG_BAR + i, 0, rows, LCD_WG_ROWS);
+	}
+}
+
+/*************************************************************************
+Function: lcd_wg_bar()
+Purpose:  Put a horizontal bar into the framebuffer
+Input:    value, full scale value, column, line, cells
+Returns:  none
+**************************************************************************/
+void lcd_wg_bar(uint16_t value, uint16_t max, uint8_t col, uint8_t line, uint8_t width)
+{
+	uint8_t px;
+	char c;
+
+	px = lcd_wg_scale(value, max, width * LCD_WG_PIXELS);
+	while (width--) {
+		if (px >= LCD_WG_PIXELS) {
+			c = LCD_WG_FULL;
+			px -= LCD_WG_PIXELS;
+		}
+		else if (px) {
+			c = LCD_WG_CODE(LCD_WG_BAR + px - 1);
+			px = 0;
+		}
+		else {
+			c = ' ';
+		}
+		lcd_fb_putc(c, col++, line);
+	}
+}
+
+/*************************************************************************
+Function: lcd_wg_spark_draw()
+Purpose:  Write the changed rows of the two glyphs
+Input:    sparkline
+Returns:  number of rows written
+**************************************************************************/
+static uint8_t lcd_wg_spark_draw(lcd_wg_spark_t *sp)
+{
+	uint8_t g, r, c, s, bits, first, last, n;
+	uint8_t *rows;
+
+	n = 0;
+	for (g = 0; g < 2; g++) {
+		rows = &sp->rows[g * LCD_WG_ROWS];
+		first = LCD_WG_ROWS;
+		last = 0;
+		for (r = 0; r < LCD_WG_ROWS; r++) {
+			// pixel is set if the sample reaches the row (row 7 is bottom)
+			bits = 0;
+			for (c = 0; c < LCD_WG_PIXELS; c++) {
+				s = g * LCD_WG_PIXELS + c;
+				if (s < LCD_WG_SAMPLES && sp->level[s] >= LCD_WG_ROWS - r) {
+					bits |= 0x10 >> c;
+				}
+			}
+			if (bits != rows[r]) {
+				rows[r] = bits;
+				if (first == LCD_WG_ROWS) first = r;
+				last = r;
+			}
+		}
+		if (first < LCD_WG_ROWS) {
+			lcd_fb_glyph(sp->code + g, first, &rows[first], last - first + 1);
+			n += last - first + 1;
+		}
+	}
+	return n;
+}
+
+/*************************************************************************
+Function: lcd_wg_spark_init()
+Purpose:  Clear the glyphs of a sparkline and put its cells
+Input:    sparkline, first glyph, column, line
+Returns:  none
+**************************************************************************/
+void lcd_wg_spark_init(lcd_wg_spark_t *sp, uint8_t code, uint8_t col, uint8_t line)
+{
+	uint8_t i;
+
+	sp->code = code;
+	for (i = 0; i < LCD_WG_SAMPLES; i++) {
+		sp->level[i] = 0;
+	}
+	for (i = 0; i < 2*LCD_WG_ROWS; i++) {
+		sp->rows[i] = 0;
+	}
+	lcd_fb_glyph(code, 0, &sp->rows[0], LCD_WG_ROWS);
+	lcd_fb_glyph(code + 1, 0, &sp->rows[LCD_WG_ROWS], LCD_WG_ROWS);
+	lcd_fb_putc(LCD_WG_CODE(code), col, line);
+	lcd_fb_putc(LCD_WG_CODE(code + 1), col + 1, line);
+}
+
+/*************************************************************************
+Function: lcd_wg_spark_add()
+Purpose:  Shift in a new sample and update the glyphs
+Input:    sparkline, sample, full scale value
+Returns:  number of rows written
+**************************************************************************/
+uint8_t lcd_wg_spark_add(lcd_wg_spark_t *sp, uint16_t value, uint16_t max)
+{
+	uint8_t i;
+
+	for (i = 0; i < LCD_WG_SAMPLES-1; i++) {
+		sp->level[i] = sp->level[i+1];
+	}
+	sp->level[LCD_WG_SAMPLES-1] = lcd_wg_scale(value, max, LCD_WG_ROWS);
+	return lcd_wg_spark_draw(sp);
+}
+
+/*************************************************************************
+Function: lcd_wg_spark_redraw()
+Purpose:  Write both glyphs again, e.g. to a new display
+Input:    sparkline
+Returns:  none
+**************************************************************************/
+void lcd_wg_spark_redraw(lcd_wg_spark_t *sp)
+{
+	uint8_t i;
+
+	for (i = 0; i < 2*LCD_WG_ROWS; i++) {
+		sp->rows[i] = 0xFF;		// no 5 bit row, all rows differ
+	}
+	lcd_wg_spark_draw(sp);
+}
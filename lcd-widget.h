@@ -0,0 +1,124 @@
+/*************************************************************************
+Title:		LCD widgets
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		lcd-widget.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 4x20 via disp
+Description: 	Bar graphs and sparklines from the CGRAM glyphs
+Usage:
+*************************************************************************/
+
+#ifndef LCD_WIDGET_H
+	#define LCD_WIDGET_H
+
+/**
+ *  @defgroup moe_LCD_WIDGET LCD widgets
+ *  @code #include <lcd-widget.h> @endcode
+ *
+ *  @brief Horizontal bar graphs and 8 sample sparklines
+ *
+ *	The eight CGRAM glyphs are shared:
+ *	- glyph 0..3: bar with 1..4 of 5 columns, defined once by
+ *	  lcd_wg_init(), a full cell is the block char 0xFF of the ROM
+ *	- glyph 4..7: two sparklines with two glyphs each
+ *
+ *	A bar is written into the framebuffer, so only the changed cells are
+ *	sent by lcd_fb_flush(). A sparkline occupies two fixed cells, one
+ *	pixel column per sample. A new sample rewrites only the changed rows
+ *	of the two glyphs, the cells themselves are not written again.
+ *	The glyphs are shown with the codes 8..15, so the cells can be part
+ *	of a string.
+ *
+ *	@code
+ *	lcd_wg_spark_t trend;
+ *	lcd_fb_init();
+ *	lcd_wg_init();
+ *	lcd_wg_spark_init(&trend, LCD_WG_SPARK0, 1, 4);
+ *	...
+ *	lcd_wg_bar(adc, 1023, 0, 3, 20);
+ *	lcd_wg_spark_add(&trend, adc, 1023);
+ *	lcd_fb_flush();
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define LCD_WG_BAR			0		// first glyph of the bar (1 column)
+#define LCD_WG_SPARK0		4		// glyphs of sparkline 0
+#define LCD_WG_SPARK1		6		// glyphs of sparkline 1
+#define LCD_WG_SAMPLES		8		// samples of a sparkline
+#define LCD_WG_ROWS			8		// rows of a glyph
+#define LCD_WG_FULL			0xFF	// full block of the character ROM
+
+/** @brief State of one sparkline */
+typedef struct {
+	uint8_t code;							// first of two glyphs
+	uint8_t level[LCD_WG_SAMPLES];			// 0..8 pixels, oldest first
+	uint8_t rows[2*LCD_WG_ROWS];			// glyph rows on the display
+} lcd_wg_spark_t;
+
+/**
+ *	@brief   Define the bar glyphs
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void lcd_wg_init(void);
+
+/**
+ *	@brief   Put a horizontal bar into the framebuffer
+ *
+ *	The bar has a resolution of 5 pixels per cell, the cells behind the
+ *	bar are cleared.
+ *
+ *  @param value	Value, 0..max
+ *  @param max		Value of the full bar
+ *  @param col		Column 0..19
+ *  @param line		Line 1..4
+ *  @param width	Cells
+ * 	@return  none
+*/
+void lcd_wg_bar(uint16_t value, uint16_t max, uint8_t col, uint8_t line, uint8_t width);
+
+/**
+ *	@brief   Place an empty sparkline
+ *
+ *  @param sp		Sparkline
+ *  @param code		Glyphs, LCD_WG_SPARK0 or LCD_WG_SPARK1
+ *  @param col		Column 0..18, the sparkline has two cells
+ *  @param line		Line 1..4
+ * 	@return  none
+*/
+void lcd_wg_spark_init(lcd_wg_spark_t *sp, uint8_t code, uint8_t col, uint8_t line);
+
+/**
+ *	@brief   Add a sample, the oldest sample is dropped
+ *
+ *	The changed glyph rows are written to the display at once.
+ *
+ *  @param sp		Sparkline
+ *  @param value	Sample, 0..max
+ *  @param max		Value of the full height
+ * 	@return  Number of glyph rows written
+*/
+uint8_t lcd_wg_spark_add(lcd_wg_spark_t *sp, uint16_t value, uint16_t max);
+
+/**
+ *	@brief   Write the glyphs of a sparkline again
+ *
+ *	After the display was replaced or reset, the samples are kept.
+ *
+ *  @param sp		Sparkline
+ * 	@return  none
+*/
+void lcd_wg_spark_redraw(lcd_wg_spark_t *sp);
+
+/**@}*/
+
+#endif
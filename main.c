@@ -16,11 +16,11 @@
  *	AREF	21				
  *			9		PB6		XTAL1
  *			10		PB7		XTAL2
- *	D2		4		PD2		SW1				
+ *	D2		4		PD2		SW1 / flow meter (INT0)				
  *	D3		5		PD3		SW2			
  *	D4		6		PD4		DHT11 - control
- *	D5		11		PD5		Buzzer
- *	D6		12	 	PD6		IR-Receiver
+ *	D5		11		PD5		Buzzer / dosing valve
+ *	D6		12	 	PD6		IR-Receiver / pump output (PID, PWM)
  *	D7		13		PD7		Extension pins (GND/5V/D7)	
  *	D8		14		PB0		Extension pins (GND/5V/D8)	
  *	D9		15		PB1		RGB-Led - red
@@ -31,10 +31,20 @@
  *	A0		23		PC0		Poti
  *	A1		24		PC1		LDR			
  *	A2		25		PC2		LM35D					
- *	A3		26		PC3		Extension pins (GND/5V/A3)			
+ *	A3		26		PC3		Extension pins (GND/5V/A3), KEY2			
  *	A4		27		PC4		SDA
  *	A5		28		PC5		SCL
  * @endcode
+ *
+ * @section sec3 Timers
+ * @code
+ * Timer0	CTC every LCD_TICK_US (50us, 20us with LCD_RW): LCD queue;
+ *			divided down to the system tick every TICK_US (200us): ADC
+ *			start, pump PWM, flow holdoff, keys (10ms), clock and i2c
+ *			supervision (100ms)
+ * Timer1	free, e.g. input capture of the flow meter
+ * Timer2	free, e.g. PWM or Modbus gap timing
+ * @endcode
 */
 #include <stdbool.h>
 #include <stdint.h> 
@@ -47,30 +57,64 @@
 #include <string.h> // itoa
 #include <ctype.h> // isdigit
 //#include <avr/eeprom.h>
-#include "i2c_lcd.h"
 #include "i2cmaster.h"
+#include "i2c-scan.h" // finds the i2c-LCD (PCF8574 / PCF8574A)
 #include "uart.h"
 #include "adc-init.h"
+#include "at-parser.h" // SIM900 responses, fed from the UART
 #include "my-routines.h"
-#include "lcd-routines.h" // all pins must be on one port, support i2c
+#include "lcd-routines.h" // lcd_tick(), LCD_TICK_US
+#include "disp.h" // display backend: parallel or i2c
+#include "lcd-fb.h"
+#include "lcd-widget.h"
+#include "menu.h"
+#include "key-debounce.h" // KEY1, KEY2
+#include "soft-clock.h" // time and date, trimmed
+#include "calendar.h" // Unix time stamps and formatting
+#include "ds3231.h" // optional RTC
+#include "pid-ctrl.h" // pressure control
+#include "dosing.h" // flow pulses on INT0, batches
+#include "schedule.h" // weekly programs of the valve
+#include "pump-guard.h" // dry run and oscillation trip
+#include "supervisor.h" // watchdog with heartbeats
 #include <avr/wdt.h> /*Watchdog timer handling*/
 
 
 /** constants and macros */
-#define I2C_DEV_ID1 0b01000000	// i2c-ID of PCF8574; 	Adress:0100&A2&A1&A0&0; Vdd= 5V, Vss = GND
-//#define I2C_DEV_ID1 0b01110000	// i2c-ID of PCF8574T; 	Adress:0111&A2&A1&A0&0; Vdd= 5V, Vss = GND
 #define UART_BAUD_RATE 19200// 19200 baud
 #define UART_MAXSTRLEN 70
+#define TREND_SEC 10 // seconds per sample of the trends
+#define TREND_FLOW_MAX 20 // flow pulses per sample of a full trend
+#define TICK_US 200 // system tick: ADC, pump PWM, flow holdoff, keys
+#define TICK_SUB (TICK_US / LCD_TICK_US) // Timer0 compares (LCD ticks) per system tick
+#define TICK_OCR (F_CPU / 8 * LCD_TICK_US / 1000000UL - 1) // CTC, prescaler 8
+#define TICK_KEYS (10000 / TICK_US) // ticks per debounce sample (10ms)
+#define TICK_CLOCK 10 // debounce samples per clock tick (100ms)
+#define PRESS_CH 1 // ADC1: pressure, converted every system tick
+#define CTRL_SAMPLES 64 // conversions per control step (12.8ms), mean of them
+#define CTRL_KP (2*PID_ONE) // gains per control step, PID_ONE = 1.0
+#define CTRL_KI (PID_ONE/16)
+#define CTRL_KD 0
+#define CTRL_RATE 2 // max duty change per step: 0..255 in 1.6s
+#define PUMP_DDR DDRD
+#define PUMP_PORT PORTD
+#define PUMP_PIN PD6 // soft PWM, period 256 ticks (51ms)
+#define TASK_ADC 0x01 // heartbeats: control step (ISR)
+#define TASK_METER 0x02 // loop up to the 100ms block: flow, keys, commands, clock, i2c
+#define TASK_COMMS 0x04 // UART output: buffer empty or bytes sent
+#define TASK_DISPLAY 0x08 // LCD update, every second
+#define TASK_ALL (TASK_ADC | TASK_METER | TASK_COMMS | TASK_DISPLAY)
+#if CTRL_SAMPLES * 1023UL > 0xFFFF
+	#error "CTRL_SAMPLES too large for the 16 bit sum"
+#endif
+#if TICK_OCR > 255 || TICK_OCR < 1 || TICK_KEYS > 255
+	#error "LCD_TICK_US does not fit Timer0 at this F_CPU"
+#endif
+#if TICK_US % LCD_TICK_US || TICK_SUB > 255
+	#error "TICK_US has to be a multiple of LCD_TICK_US"
+#endif
 
 // https://www.mikrocontroller.net/articles/Entprellung
-#define KEY_DDR         DDRD
-#define KEY_PORT        PORTD
-#define KEY_PIN         PIND
-#define KEY0            2
-#define KEY1            3
-#define KEY2            2
-#define ALL_KEYS        (1<<KEY0 | 1<<KEY1 | 1<<KEY2)
- 
 #define REPEAT_MASK     (1<<KEY1 | 1<<KEY2)       // repeat: key1, key2
 #define REPEAT_START    50                        // after 500ms
 #define REPEAT_NEXT     20                        // every 200ms
@@ -78,25 +122,17 @@
 
 /**@{*/
 /* Global variable declaration */
-volatile int tc;		// Laufvariable
+volatile uint8_t tc;		// pending 100ms ticks
 volatile uint8_t uart_str_complete = 0;     // 1 .. String komplett empfangen
 volatile uint8_t uart_str_count = 0;
-unsigned char msec = 0;
-unsigned char sec = 0;
-unsigned char min = 0;
-unsigned char hour = 0;
-unsigned int day = 0;
-char str_msec[4];
-char str_sec[3];
-char str_min[3];
-char str_hour[3];
 char str_keys[2];
-char str_time[9]; // 9-> hh:mm:ss 13->hh:mm:ss:mss
+char str_time[CAL_TIME_LEN + 1]; // hh:mm:ss
+char str_date[CAL_DATE_LEN + 1]; // YYYY-MM-DD
 
 char uart_string[UART_MAXSTRLEN + 1] = "";
 uint8_t i; 
 uint8_t j;
-uint8_t k;
+uint16_t k;
 
 unsigned char ret;
 
@@ -108,29 +144,54 @@ char l_buffer[22];
 char l_buffer_new[22];
 
 // ADC-channel
-char adc_channel_start = 1; // start with ADC-nr1
-char adc_channel_max = 1; // Maximum number of ADC channels
 uint32_t adc_results[4]; // results of ADC measurements (ADC0-ADC3)
-char adc_res_avg_max = 1; // number of ADC values to create mean value
-uint8_t adc_channel; // current ADC_channel
-char adc_res_avg; // current ADC run of adc_res_avg_max
+volatile uint16_t adc_press; // mean of the last control step
 uint32_t adc_temp; // Temporary storage register
+uint16_t p_gain = 48876; // ADC value * p_gain = pressure [1e-7 bar]
+uint16_t p_max = 60; // pressure alarm [0.1 bar]
+uint16_t p_set = 30; // pressure setpoint [0.1 bar]
+uint16_t p_man = 0; // pump duty in manual mode [%]
 volatile uint8_t adc_update = 0; // 1...Flag that ADC-result is finished
-char adc_restart; // Restart ADC
-char adc_string[12];
-char adc_run; // indicates that the ADC is in operation
+char adc_restart; // evaluate the pressure
+pid_ctrl_t pump; // pressure control
+uint16_t p_dry = 5; // dry run below this pressure [0.1 bar]
+volatile uint8_t pump_auto; // 1 ... auto mode before a trip
+uint8_t pump_fault; // faults already reported
+int32_t wdt_resets; // watchdog resets, from the EEPROM
+volatile uint8_t pump_duty; // 0..255 of the soft PWM
 char adc_eval[12]; // string including commas
 
 // Flow-meter
-char flow_string[12];
 char flow_eval[12];
 int32_t total_flow;
 
-// Key
-volatile uint8_t key_state;                                // debounced and inverted key state:
-                                                  // bit = 1: key pressed
-volatile uint8_t key_press;                                // key press detect
-volatile uint8_t key_rpt;                                  // key long press and repeat
+// Trends on the LCD
+lcd_wg_spark_t trend_press; // pressure, ADC value
+lcd_wg_spark_t trend_flow; // flow pulses per TREND_SEC
+int32_t trend_total; // total_flow at the last sample
+uint8_t lcd_dev = 0xFF; // address of the i2c-LCD, 0 = parallel LCD
+uint8_t lcd_lost; // i2c-LCD missed by the scan or dropped, init when it answers
+uint8_t trend_sec;
+uint8_t rtc_ok; // DS3231 found by the bus scan
+clk_time_t rtc_time;
+int32_t flow_midnight; // total_flow at the last midnight
+int32_t flow_day; // consumption of the last day
+uint16_t dose_l = 100; // batch volume [l], 1 pulse = 1 l
+uint16_t dose_over = 0; // overrun compensation [l]
+int32_t dose_last; // achieved volume of the last batch [l]
+dose_result_t dose_res;
+uint16_t sched_now; // minute of the week of the last evaluation
+uint16_t valve_min; // minutes left of a timed program
+
+// SIM900 on the UART: every received char goes through the AT parser
+at_parser_t gsm_p;
+at_resp_t gsm_r;
+uint8_t gsm_bars; // signal bars of the last +CSQ
+signed char gsm_reg = -1; // registration state of the last +CREG
+char gsm_sig[4]; // signal strength [%] of the last +CSQ
+char sms_str[7]; // number of the last indicated SMS
+char sms_phone[AT_STR_LEN]; // sender of the last SMS read
+
 int32_t press_short;
 int32_t press_long;
 char str_press_short[12];
@@ -139,8 +200,6 @@ char str_press_long[12];
 
 // Flags
 char flag_sec = 0;
-char flag_min = 0;
-char flag_hour = 0;
 char flag_day = 0;
 char update_lcd = 0;
 char update_uart= 0;
@@ -151,306 +210,563 @@ char update_uart= 0;
 
 
 /* EEPROM variable declaration */
+uint16_t ee_p_gain EEMEM = 48876;
+uint16_t ee_p_max EEMEM = 60;
+uint16_t ee_p_set EEMEM = 30;
+int16_t ee_clk_trim EEMEM = 0; // ppm, learned from the RTC
+uint16_t ee_dose_l EEMEM = 100;
+uint16_t ee_p_dry EEMEM = 5;
+uint16_t ee_dose_over EEMEM = 0;
  
 
 /* Prototypes */
-ISR( TIMER0_OVF_vect )                            // every 10ms
+ISR( TIMER0_COMPA_vect )                          // LCD tick, every LCD_TICK_US
 {
-  static uint8_t ct0 = 0xFF, ct1 = 0xFF, rpt;
-  uint8_t i;
- 
-  TCNT0 = (uint8_t)(int16_t)-(F_CPU / 1024 * 10e-3 + 0.5);  // preload for 10ms
- 
-  i = key_state ^ ~KEY_PIN;                       // key changed ?
-  ct0 = ~( ct0 & i );                             // reset or count ct0
-  ct1 = ct0 ^ (ct1 & i);                          // reset or count ct1
-  i &= ct0 & ct1;                                 // count until roll over ?
-  key_state ^= i;                                 // then toggle debounced state
-  key_press |= key_state & i;                     // 0->1: key press detect
- 
-  if( (key_state & REPEAT_MASK) == 0 )            // check repeat function
-     rpt = REPEAT_START;                          // start delay
-  if( --rpt == 0 ){
-    rpt = REPEAT_NEXT;                            // repeat delay
-    key_rpt |= key_state & REPEAT_MASK;
-  }
+  static uint8_t t_sub, t_keys, t_clock, t_pwm;
+
+  lcd_tick();                                     // next byte of the LCD queue
+  if( ++t_sub < TICK_SUB )
+    return;
+  t_sub = 0;                                      // system tick, every TICK_US
+  ADCSRA = (ADCSRA & ~(1<<ADIF)) | 1<<ADSC;       // pressure sample, ADIF kept
+  if( t_pwm++ < pump_duty )                       // pump output, soft PWM
+    PUMP_PORT |= 1<<PUMP_PIN;
+  else
+    PUMP_PORT &= ~(1<<PUMP_PIN);
+  dose_systick();                                 // flow input holdoff
+  if( ++t_keys < TICK_KEYS )
+    return;
+  t_keys = 0;
+  key_tick();                                     // debounce KEY1, KEY2, 10ms
+  if( ++t_clock < TICK_CLOCK )
+    return;
+  t_clock = 0;
+  tc++;                                           // 100ms for the main loop
+  i2c_tick();                                     // abort hanging i2c transactions
 }
 
-ISR(TIMER1_OVF_vect)
-{	
-	TCNT1 = 59286 ; // 1sec = 3036; 
-	tc++; // 65536 - 16e6 / 256 = 3036
-	// 100 ms counter
-}
-
-ISR(ADC_vect) // Interrupt subroutine for ADC conversion complete
+ISR(ADC_vect) // conversion complete, started by the system tick
 {
+	static uint16_t sum;
+	static uint8_t n;
+
+	sum += ADCW;
+	if (++n < CTRL_SAMPLES) return;
+	adc_press = sum / CTRL_SAMPLES; // power of 2: a shift
+	sum = 0;
+	n = 0;
+	pump_duty = pid_step(&pump, adc_press); // fixed rate, few hundred cycles
+	sup_beat(TASK_ADC);
+	if (guard_step(pump_duty, adc_press, dose_flow)) { // tripped, latched
+		if (pump.mode == PID_AUTO) {
+			pump_auto = 1;
+			pid_mode(&pump, PID_MANUAL);
+		}
+		pump.manual = 0; // the loop ramps down, restarts from 0
+		pump_duty = 0;
+	}
 	adc_update = 1;
 } 
 
 ///////////////////////////////////////////////////////////////////
 //
-// check if a key has been pressed. Each pressed key is reported
-// only once
+// settings in the EEPROM, an erased word keeps the default
 //
-uint8_t get_key_press( uint8_t key_mask )
+void settings_load(void)
 {
-  cli();                                          // read and clear atomic !
-  key_mask &= key_press;                          // read key(s)
-  key_press ^= key_mask;                          // clear key(s)
-  sei();
-  return key_mask;
+	uint16_t v;
+
+	v = eeprom_read_word(&ee_p_gain);
+	if (v != 0xFFFF) p_gain = v;
+	v = eeprom_read_word(&ee_p_max);
+	if (v != 0xFFFF) p_max = v;
+	v = eeprom_read_word(&ee_p_set);
+	if (v != 0xFFFF) p_set = v;
+	v = eeprom_read_word((uint16_t *)&ee_clk_trim);
+	if (v != 0xFFFF) clk_trim((int16_t)v); // -1ppm is taken as erased
+	v = eeprom_read_word(&ee_p_dry);
+	if (v != 0xFFFF) p_dry = v;
+	v = eeprom_read_word(&ee_dose_l);
+	if (v != 0xFFFF) dose_l = v;
+	v = eeprom_read_word(&ee_dose_over);
+	if (v != 0xFFFF) dose_over = v;
+	dose_overrun = dose_over;
 }
- 
-///////////////////////////////////////////////////////////////////
+
+void settings_save(void)
+{
+	if (eeprom_read_word(&ee_p_gain) != p_gain) eeprom_write_word(&ee_p_gain, p_gain);
+	if (eeprom_read_word(&ee_p_max) != p_max) eeprom_write_word(&ee_p_max, p_max);
+	if (eeprom_read_word(&ee_p_set) != p_set) eeprom_write_word(&ee_p_set, p_set);
+	if (eeprom_read_word((uint16_t *)&ee_clk_trim) != (uint16_t)clk_trim_get()) {
+		eeprom_write_word((uint16_t *)&ee_clk_trim, (uint16_t)clk_trim_get());
+	}
+	if (eeprom_read_word(&ee_p_dry) != p_dry) eeprom_write_word(&ee_p_dry, p_dry);
+	if (eeprom_read_word(&ee_dose_l) != dose_l) eeprom_write_word(&ee_dose_l, dose_l);
+	if (eeprom_read_word(&ee_dose_over) != dose_over) eeprom_write_word(&ee_dose_over, dose_over);
+}
+
+void flow_reset(void)
+{
+	press_short = 0;
+	total_flow = 0;
+	flow_midnight = 0;
+	trend_total = 0;
+	my_fix_str(flow_eval, sizeof(flow_eval), press_short, 3, 3, 6);
+}
+
 //
-// check if a key has been pressed long enough such that the
-// key repeat functionality kicks in. After a small setup delay
-// the key is reported being pressed in subsequent calls
-// to this function. This simulates the user repeatedly
-// pressing and releasing the key.
+// pressure control: setpoint [0.1 bar] in ADC steps, manual duty, mode
 //
-uint8_t get_key_rpt( uint8_t key_mask )
+void ctrl_update(void)
 {
-  cli();                                          // read and clear atomic !
-  key_mask &= key_rpt;                            // read key(s)
-  key_rpt ^= key_mask;                            // clear key(s)
-  sei();
-  return key_mask;
+	cli();
+	pump.setpoint = (uint32_t)p_set * 1000000UL / p_gain;
+	pump.manual = (uint32_t)p_man * 255 / 100;
+	guard_p_low = (uint32_t)p_dry * 1000000UL / p_gain;
+	sei();
+}
+
+void ctrl_apply(void)
+{
+	settings_save();
+	ctrl_update();
+}
+
+void ctrl_toggle(void)
+{
+	cli();
+	pid_mode(&pump, pump.mode == PID_AUTO ? PID_MANUAL : PID_AUTO); // bumpless
+	pump_auto = 0;
+	sei();
+}
+
+// pump guard: acknowledge a trip, the mode before is restored
+void ctrl_ack(void)
+{
+	if (!guard_fault()) return;
+	ctrl_update(); // manual duty from p_man
+	cli();
+	if (pump_auto) pid_mode(&pump, PID_AUTO); // from the ramped down duty
+	pump_auto = 0;
+	sei();
+	guard_ack();
+	pump_fault = 0;
+	uart_puts("Fault ack\n");
 }
 
-///////////////////////////////////////////////////////////////////
 //
-// check if a key is pressed right now
+// dosing: batch of dose_l pulses, the valve is closed by INT0
 //
-uint8_t get_key_state( uint8_t key_mask )
+void dose_apply(void)
+{
+	settings_save();
+	dose_overrun = dose_over; // from the next batch on
+}
 
+void dose_go(void)
 {
-  key_mask &= key_state;
-  return key_mask;
+	dose_start(dose_l);
+}
+
+void dose_end(void)
+{
+	valve_min = 0;
+	dose_stop();
+}
+
+// report: requested/achieved [l] and the compensation, e.g. "Dose 100/101 -2"
+void dose_report(void)
+{
+	dose_last = dose_res.achieved;
+	uart_puts("Dose ");
+	my_fix_UART(dose_res.requested, 0, 0, 1);
+	uart_puts("/");
+	my_fix_UART(dose_res.achieved, 0, 0, 1);
+	uart_puts(" -");
+	my_fix_UART(dose_res.overrun, 0, 0, 1);
+	uart_puts(dose_res.aborted ? " stop\n" : "\n");
 }
 
-///////////////////////////////////////////////////////////////////
 //
-uint8_t get_key_short( uint8_t key_mask )
+// schedule: every minute, valve 0 is the dosing valve
+//
+void sched_run(void)
 {
-  cli();                                          // read key state and key press atomic !
-  return get_key_press( ~key_state & key_mask );
+	char line[SCHED_LINE_LEN + 1];
+	const sched_prog_t *p;
+	uint8_t i;
+
+	sched_now = sched_minute(clk_now());
+	if (valve_min && --valve_min == 0) dose_stop(); // timed program done
+	while ((i = sched_due(sched_now)) != SCHED_NONE) { // only the planned start
+		p = &sched_prog[i];
+		uart_puts(sched_format(line, i));
+		if (!dose_start(p->mode == SCHED_VOLUME ? p->amount : 0)) {
+			uart_puts(" busy\n"); // valve in use, skipped
+			continue;
+		}
+		valve_min = (p->mode == SCHED_TIME) ? p->amount : 0;
+		uart_puts(" start\n");
+	}
 }
- 
-///////////////////////////////////////////////////////////////////
+
+//
+// UART commands, one line: "P" lists the programs, "P1 ..." see schedule.h,
+// "T" date and time, "T YYYY-MM-DD hh:mm:ss" sets the clock and the RTC,
+// "ACK" acknowledges a pump fault
+//
+void uart_command(void)
+{
+	char line[SCHED_LINE_LEN + 1];
+	uint8_t i;
+
+	if (strcmp(uart_string, "ACK") == 0) {
+		ctrl_ack();
+		return;
+	}
+	if (uart_string[0] == 'T') { // "T" date and time, "T YYYY-MM-DD hh:mm:ss" set
+		if (uart_string[1] != '\0') {
+			if (uart_string[1] != ' ' || !cal_parse(uart_string + 2, &rtc_time)) {
+				uart_puts("ERR\n");
+				return;
+			}
+			clk_set(&rtc_time);
+			if (rtc_ok && ds3231_write(&rtc_time) != I2C_OK) uart_puts("RTC ERR\n");
+			sched_now = sched_minute(clk_now());
+			sched_plan(sched_now);
+		}
+		uart_puts(cal_format_date(line, &clk));
+		uart_puts(" ");
+		uart_puts(cal_format_time(line, &clk));
+		uart_puts("\n");
+		return;
+	}
+	if (uart_string[0] == 'P' && uart_string[1] == '\0') {
+		for (i = 0; i < SCHED_PROGS; i++) {
+			uart_puts(sched_format(line, i));
+			uart_puts("\n");
+		}
+		return;
+	}
+	i = sched_parse(uart_string);
+	if (i == SCHED_NONE) {
+		uart_puts("ERR\n");
+		return;
+	}
+	sched_plan(sched_now); // a change starts after this minute
+	uart_puts(sched_format(line, i));
+	uart_puts("\n");
+}
+
+//
+// SIM900 response complete: take the fields straight from the parser,
+// a new SMS is read at once
+//
+void gsm_response(uint8_t type)
+{
+	switch (type) {
+		case AT_RESP_CSQ:
+			gsm_bars = SIM900_AT_CSQ(gsm_sig, &gsm_r);
+			break;
+		case AT_RESP_CREG:
+			gsm_reg = SIM900_AT_CREG(&gsm_r);
+			break;
+		case AT_RESP_CMTI:
+			if (SIM900_AT_CMTI(sms_str, &gsm_r) >= 0) {
+				uart_puts("AT+CMGR=");
+				uart_puts(sms_str);
+				uart_puts("\r\n");
+			}
+			break;
+		case AT_RESP_CMGR:
+			SIM900_AT_CMGR(sms_phone, sizeof(sms_phone), &gsm_r);
+			break;
+	}
+}
+
+//
+// reset cause and the tasks without heartbeat of the last watchdog reset
+//
+void sup_report(void)
+{
+	wdt_resets = sup_rec.count;
+	uart_puts("Reset");
+	if (sup_rec.cause & (1<<PORF)) uart_puts(" power");
+	if (sup_rec.cause & (1<<EXTRF)) uart_puts(" external");
+	if (sup_rec.cause & (1<<BORF)) uart_puts(" brown-out");
+	if (sup_rec.cause & (1<<WDRF)) {
+		if (sup_rec.tasks & SUP_BOOT) {
+			uart_puts(" watchdog, start up");
+		}
+		else {
+			uart_puts(" watchdog, tasks ");
+			my_fix_UART(sup_rec.tasks, 0, 0, 1); // TASK_..., lowest bit hangs
+		}
+	}
+	uart_puts("\n");
+}
+
 //
-uint8_t get_key_long( uint8_t key_mask )
+// display: i2c-LCD found by the bus scan (any address of the PCF8574 or
+// PCF8574A), else the parallel LCD; returns 1 if the display was changed
+// or initialised again. An i2c-LCD which was replugged between two probes
+// is seen by its failed writes (i2c_dev_ok), it starts in 8 bit mode.
+//
+uint8_t display_select(void)
 {
-  return get_key_press( get_key_rpt( key_mask ));
+	uint8_t dev;
+
+	dev = i2c_scan_find(I2C_SCAN_LCD);
+	if (lcd_dev && lcd_dev != 0xFF) {
+		if (!i2c_dev_ok(lcd_dev)) lcd_lost = 1;
+		if (dev == lcd_dev && lcd_lost && i2c_dev_ok(lcd_dev)) { // answers again
+			lcd_lost = 0;
+			disp_init(&disp_pcf8574);
+			return 1;
+		}
+	}
+	if (dev == lcd_dev) return 0;
+	if (!dev && lcd_dev && lcd_dev != 0xFF && i2c_dev_ok(lcd_dev)) { // one missed probe
+		lcd_lost = 1;
+		return 0;
+	}
+	lcd_dev = dev;
+	lcd_lost = 0;
+	if (dev) {
+		disp_pcf_address(dev);
+		disp_init(&disp_pcf8574);
+	}
+	else {
+		disp_init(&disp_hd44780);
+	}
+	return 1;
 }
 
+// Menu
+static const char menu_l_total[] PROGMEM = "Total m3";
+static const char menu_l_reset[] PROGMEM = "Reset m3";
+static const char menu_l_day[] PROGMEM = "Day m3";
+static const char menu_l_p_max[] PROGMEM = "Alarm bar";
+static const char menu_l_p_gain[] PROGMEM = "Cal. bar";
+static const char menu_l_p_set[] PROGMEM = "Set bar";
+static const char menu_l_p_man[] PROGMEM = "Pump %";
+static const char menu_l_mode[] PROGMEM = "Auto/Man";
+static const char menu_l_p_dry[] PROGMEM = "Dry bar";
+static const char menu_l_ack[] PROGMEM = "Fault ack";
+static const char menu_l_wdt[] PROGMEM = "WDT resets";
+static const char menu_l_dose[] PROGMEM = "Dose l";
+static const char menu_l_over[] PROGMEM = "Overrun l";
+static const char menu_l_start[] PROGMEM = "Dose go";
+static const char menu_l_stop[] PROGMEM = "Dose stop";
+static const char menu_l_last[] PROGMEM = "Dosed l";
+static const menu_item_t menu_items[] PROGMEM = {
+	{ menu_l_total,	MENU_VIEW,		3,	&total_flow,	0,		0,		0,	NULL },
+	{ menu_l_day,	MENU_VIEW,		3,	&flow_day,		0,		0,		0,	NULL },
+	{ menu_l_reset,	MENU_ACTION,	0,	NULL,			0,		0,		0,	flow_reset },
+	{ menu_l_p_max,	MENU_EDIT,		1,	&p_max,			0,		160,	1,	settings_save },
+	{ menu_l_p_gain,MENU_EDIT,		0,	&p_gain,		40000,	60000,	10,	ctrl_apply },
+	{ menu_l_p_set,	MENU_EDIT,		1,	&p_set,			0,		160,	1,	ctrl_apply },
+	{ menu_l_p_man,	MENU_EDIT,		0,	&p_man,			0,		100,	5,	ctrl_apply },
+	{ menu_l_mode,	MENU_ACTION,	0,	NULL,			0,		0,		0,	ctrl_toggle },
+	{ menu_l_p_dry,	MENU_EDIT,		1,	&p_dry,			0,		160,	1,	ctrl_apply },
+	{ menu_l_ack,	MENU_ACTION,	0,	NULL,			0,		0,		0,	ctrl_ack },
+	{ menu_l_wdt,	MENU_VIEW,		0,	&wdt_resets,	0,		0,		0,	NULL },
+	{ menu_l_dose,	MENU_EDIT,		0,	&dose_l,		1,		60000,	10,	settings_save },
+	{ menu_l_over,	MENU_EDIT,		0,	&dose_over,		0,		50,		1,	dose_apply },
+	{ menu_l_start,	MENU_ACTION,	0,	NULL,			0,		0,		0,	dose_go },
+	{ menu_l_stop,	MENU_ACTION,	0,	NULL,			0,		0,		0,	dose_end },
+	{ menu_l_last,	MENU_VIEW,		0,	&dose_last,		0,		0,		0,	NULL },
+};
+
 int main(void)
 {
-	
+	sup_init(TASK_ALL); // watchdog on, first the start up is supervised
+	settings_load();
 	adc_init_i(1,1); // AVCC as reference/Enable ADC-interrupt
+	adc_read_i(PRESS_CH); // then started every system tick
+	pid_init(&pump, CTRL_KP, CTRL_KI, CTRL_KD, 0, 255, CTRL_RATE); // manual, off
+	ctrl_update(); // setpoint and manual duty
+	PUMP_DDR |= 1<<PUMP_PIN;
 	uart_init( UART_BAUD_SELECT(UART_BAUD_RATE,F_CPU) );
+	at_parser_init(&gsm_p, &gsm_r);
 	
 	sei(); // Interrupt based UART-Liberary
 	uart_puts("\nUART ready\n");
+	sup_report();
 	
-	/* Configure debouncing routines with Timer/Counter0 */
+	/* System tick and debouncing routines with Timer/Counter0 */
 	press_short = 0;
 	press_long = 0;
-	KEY_DDR &= ~ALL_KEYS;                // configure key port for input
-	KEY_PORT |= ALL_KEYS;                // and turn on pull up resistors
-	TCCR0B = (1<<CS02)|(1<<CS00);         // divide by 1024
-	TCNT0 = (uint8_t)(int16_t)-(F_CPU / 1024 * 10e-3 + 0.5);  // preload for 10ms
-	TIMSK0 |= 1<<TOIE0;                   // enable timer interrupt
+	key_init();                          // inputs with pull up resistors
+	key_repeat(REPEAT_MASK, REPEAT_START, REPEAT_NEXT);
+	TCCR0A = (1<<WGM01);                  // CTC, no reload drift
+	TCCR0B = (1<<CS01);                   // divide by 8
+	OCR0A = TICK_OCR;
+	TIMSK0 |= 1<<OCIE0A;                  // enable timer interrupt
 	
 	/* Flow-meter */
+	dose_init(); // pulses on INT0, valve closed
 	total_flow = 0;
-	my_itoa(press_short,flow_string);
-	my_round(flow_string,3);
-	my_print_str(flow_string, 7, 8, 3, 1, flow_eval);
-	
-	/* Timer/Counter 1 */	
-	TIMSK1 |= _BV(TOIE1); 		// aktivate overflowinterrupts of timer1 
-	TCCR1B |= (1<<CS12);		// prescaler = 256
-	TCNT1 = 0xFFFF; 			// FFFF for start 
+	my_fix_str(flow_eval, sizeof(flow_eval), press_short, 3, 3, 6);
 	
 	
 	/* LCD-Display */
 	DDRD  |= (1 << DDD7); // Set as PIN output
 	PORTD |= (1 << PD7); // SET output LOW or deactivate internal Pullup
 	_delay_ms(500);
+	sup_boot();
 	
-	lcd_init();
-	lcd_string_p("LCD-ready",0,1);
+	i2c_init();
+	i2c_scan(); // all addresses, about 40ms
+	sup_boot();
+	rtc_ok = i2c_scan_find(I2C_SCAN_RTC) == DS3231_ADR;
+	if (rtc_ok && ds3231_read(&rtc_time) == I2C_OK) {
+		clk_sync(&rtc_time); // seed the clock, else it starts at 00:00:00
+	}
+	sched_init();
+	sched_now = sched_minute(clk_now());
+	sched_plan(sched_now);
+	display_select();
+	sup_boot();
+	lcd_fb_init(); // display is cleared, from now on only via framebuffer
+	lcd_fb_string_P("LCD-ready",0,1);
+	lcd_fb_flush();
 	_delay_ms(500);
+	sup_boot();
 	//PORTD &= ~(1 << PD7); // Light off SET output LOW or deactivate internal Pullup
-	lcd_clear();
+	lcd_fb_clear();
 	//lcd_string_p("Time:",0,1); // row/column
 
 	// ADC
-	adc_channel = adc_channel_max; // first startup of ADC
-	adc_update = 1; // first jump into the ADC routine 
-	adc_res_avg = adc_res_avg_max; // Never reached -> Intialisation
 	adc_restart = 0;
-	adc_run = 0;
-	lcd_string_p("bar",4,2); // row/column
-	lcd_string_p("m3",14,1);
-	lcd_string_p("lpm",13,2);
+	lcd_fb_string_P("bar",4,2); // row/column
+	lcd_fb_string_P("m3",14,1);
+	lcd_fb_string_P("lpm",13,2);
+	lcd_wg_init(); // line 3: pressure bar, line 4: trends
+	lcd_fb_string_P("P",0,4);
+	lcd_wg_spark_init(&trend_press, LCD_WG_SPARK0, 1, 4);
+	lcd_fb_string_P("Q",4,4);
+	lcd_wg_spark_init(&trend_flow, LCD_WG_SPARK1, 5, 4);
+	menu_init(menu_items, sizeof(menu_items)/sizeof(menu_items[0]), 3); // shown instead of the bar
 
 
 	// Set Initial values for first output
-	mystring(msec,str_msec);
-	mystring(sec,str_sec);
-	mystring(min,str_min);
-	mystring(hour,str_hour);
-	
-	// Initialize string constants
-	// Time-string
-	//	h h : m m : s s \0
-	//	0 1 2 3 4 5 6 7 8
-	str_time[0]='0';
-	str_time[1]='0';
-	str_time[2]=':';
-	str_time[3]='0';
-	str_time[4]='0';
-	str_time[5]=':';
-	str_time[6]='0';
-	str_time[7]='0';
-	str_time[8]='\0';
-	uart_puts("\nTime     bar  m3\n");
+	cal_format_date(str_date, &clk);
+	cal_format_time(str_time, &clk);
+	uart_puts("\nDate       Time     bar  m3\n");
+	uart_puts(str_date);
+	uart_puts(" ");
 	uart_puts(str_time);
+	sup_start(); // start up done, the tasks are supervised
 	
 	while (1)
 	{
+		i2c_poll(); // bus clear after an i2c abort, not in the ISRs
 	/* 0 - Flow Counter*/	
-		if( get_key_short( 1<<KEY0 )) {
-			press_short = press_short +1;
-			total_flow = total_flow + 1;
+		k = dose_take(); // pulses counted by INT0
+		if (k) {
+			press_short = press_short + k;
+			total_flow = total_flow + k;
 			
-			my_itoa(press_short,flow_string);
-			//my_round(flow_string,3);
-			my_print_str(flow_string, 7, 8, 3, 1, flow_eval);
+			my_fix_str(flow_eval, sizeof(flow_eval), press_short, 3, 3, 6); // " 0.001"
+		}
+	/* 0a - Menu on KEY1: short, long and repeat */
+		if( get_key_short( 1<<KEY1 )) {
+			menu_key(MENU_KEY_SHORT);
+			lcd_fb_flush();
+		}
+		k = get_key_rpt( 1<<KEY1 );
+		if (k) { // first repeat of a press is the long press
+			menu_key(get_key_press(k) ? MENU_KEY_LONG : MENU_KEY_RPT);
+			lcd_fb_flush();
+		}
+		
+	/* 0b - UART commands, one line */
+		k = uart_getc();
+		if (!(k & 0xFF00)) { // a char without error
+			i = at_parse_char(&gsm_p, k); // SIM900 response, no copy of the line
+			if (i != AT_RESP_NONE) gsm_response(i);
+			if (k == '\r' || k == '\n') {
+				uart_string[uart_str_count] = '\0';
+				if (uart_str_count) uart_command();
+				uart_str_count = 0;
+			}
+			else if (uart_str_count < UART_MAXSTRLEN) {
+				uart_string[uart_str_count++] = k;
+			}
 		}
-		/*if( get_key_long( 1<<KEY1 )) {
-			press_long = press_long + 1;
-			my_itoa(press_long, str_press_long);
-			uart_puts(str_press_long);
-		}*/
 		
 	/* 1 - Time routine */
 		if(!(tc==0)) // one  100msec is gone
 		{
-			msec= msec+1;
-			tc = 0;
-			if (msec>=10) { // Every second loop
-				msec =0;
-				sec = sec+1;
+			cli();
+			tc--; // a late loop catches up, the clock does not drift
+			sei();
+			i2c_scan_step();
+			if (display_select()) { // LCD plugged, unplugged or replugged
+				lcd_fb_invalidate(); // new display: write everything again
+				lcd_wg_init();
+				lcd_wg_spark_redraw(&trend_press);
+				lcd_wg_spark_redraw(&trend_flow);
+				update_lcd = 1;
+			}
+			k = clk_tick();
+			if (k & CLK_MIN) sched_run(); // programs, before the clock is synced
+			// discipline the clock every hour at half past: a step back at
+			// midnight would repeat CLK_DAY and cut the daily total short
+			if ((k & CLK_MIN) && clk.min == 30 && rtc_ok && ds3231_read(&rtc_time) == I2C_OK) {
+				k |= clk_sync(&rtc_time);
+				settings_save(); // learned trim
+				if (sched_minute(clk_now()) != sched_now) { // clock stepped
+					sched_now = sched_minute(clk_now());
+					sched_plan(sched_now);
+				}
+			}
+			if (k & CLK_SEC) { // Every second loop
 				flag_sec = 1;
 				update_lcd = 1;
 				update_uart = 1;
-				if (sec>=60) { // every minute
-					sec = 0;
-					min = min+1;
-					flag_min = 1;
-					if (min>=60) { // every hour
-						min = 0;
-						hour = hour+1;
-						flag_hour = 1;
-						if (hour>=24) { // every day
-							hour = 0;
-							flag_day = 1;
-						}	
-					}	
-				}
-			} // 1s loop
+			}
+			if (k & CLK_DAY) flag_day = 1; // every day, midnight
+			dose_tick(); // overrun after the cutoff
+			if (dose_result(&dose_res)) dose_report();
+			sup_beat(TASK_METER);
 		} // 100ms loop - End time update routine	
 		
 		
 	// Do now the not timecritical work
 		if(flag_sec==1) {
-			mystring(sec,str_sec);
-			for(i=0; i<2; i++) {
-				str_time[i+6]=str_sec[i];
-			}
+			cal_format_date(str_date, &clk); // formatted only for the output
+			cal_format_time(str_time, &clk);
 			adc_restart =1;
 			flag_sec = 0;
 		}
-		if(flag_min==1) {
-			mystring(min,str_min);
-			for(i=0; i<2; i++) {
-				str_time[i+3]=str_min[i];
-			}
-		
-			flag_min = 0;
-		}
-		if(flag_hour==1) {
-			mystring(hour,str_hour);
-			for(i=0; i<2; i++) {
-				str_time[i]=str_hour[i];
-			}
-	
-			flag_hour = 0;
-		}
 		if(flag_day==1) {
-				
+			flow_day = total_flow - flow_midnight; // daily total
+			flow_midnight = total_flow;
 			flag_day = 0;
 		}
 		
-		// Start ADC if needed
-		if (adc_restart==1){ // Restart of first ADC channel ADC
+		// Pressure: mean of the last control step, evaluated every second
+		if (adc_restart==1 && adc_update==1) {
 			adc_restart = 0;
-			adc_read_i(adc_channel); // Start ADC
-			adc_run = 1;
-		}
-		if (adc_run==0) { // Intermediate Start of ADC
-			adc_read_i(adc_channel);
-			adc_run = 1;
-		}
-		
-		// Check if ADC conversion is finished
-		if (adc_update==1) {
-			if(adc_res_avg<adc_res_avg_max) {
-				if (adc_res_avg>0) {
-					adc_results[adc_channel] = adc_results[adc_channel]+ ADCW;
-				}
-				else {
-					adc_results[adc_channel] = ADCW;
-				}
-			adc_res_avg = adc_res_avg+1;
-			}
-			else { // Initial condition
-				adc_res_avg = 0;
-				adc_channel = adc_channel_start;
-				adc_restart = 1; // Start the ADC
-			}
-			if (adc_res_avg == adc_res_avg_max) {
-				adc_res_avg = 0; // Clear index of average value
-				adc_results[adc_channel] = adc_results[adc_channel]/adc_res_avg_max;
-				adc_temp = adc_results[adc_channel]*48876;
-				
-				my_itoa(adc_temp,adc_string);
-				
-				//uart_puts(adc_string);
-				//uart_puts(" ");
-				my_round(adc_string,7);
-				my_print_str(adc_string, 3, 4, 1, 1, adc_eval);
-
-				
-
-				//lcd_setcursor(16,adc_channel+1);
-				//my_print_LCD(string, 3, 5, 1);
-				//my_print_LCD(string, 3, 4, 3);
-
-				adc_channel = adc_channel+1; // Next channel
-				if(adc_channel>=(adc_channel_start+adc_channel_max)) {
-					adc_channel = adc_channel_start;
-					adc_run = 2;
-				}
-				else {
-					adc_run = 0;
-				}
-				adc_update = 0; // clear flag
-				
+			adc_update = 0; // clear flag
+			cli();
+			adc_results[PRESS_CH] = adc_press;
+			sei();
+			adc_temp = adc_results[PRESS_CH]*p_gain;
+			
+			// adc_temp/10^7 = pressure [bar], e.g. " 2.6"
+			my_fix_str(adc_eval, sizeof(adc_eval), adc_temp, 7, 1, 4);
+			lcd_fb_putc(adc_temp >= (uint32_t)p_max*1000000 ? '!' : ' ', 7, 2);
+			lcd_fb_putc(pump.mode == PID_AUTO ? 'A' : 'M', 19, 2); // pump mode
+			k = guard_fault();
+			lcd_fb_putc(k & GUARD_DRY ? 'D' : k & GUARD_OSC ? 'C' : ' ', 18, 2);
+			if (k & ~pump_fault) { // a new trip, once
+				if (k & GUARD_DRY) uart_puts("Fault dry run\n");
+				if (k & GUARD_OSC) uart_puts("Fault pressure oscillation\n");
+				pump_fault = k;
 			}
 		}
 		// Update the lcd-screen
@@ -460,16 +776,34 @@ int main(void)
 			uart_puts(" ");
 			uart_puts(flow_eval);
 			uart_puts("\n");
+			uart_puts(str_date);
+			uart_puts(" ");
 			uart_puts(str_time);
 			
 			update_uart=0;
 		}
+		if (uart_tx_progress()) sup_beat(TASK_COMMS); // the UART sends
 		if(update_lcd==1) {	
 			//LCD-outputs
-			lcd_string_p(adc_eval,0,2);
-			lcd_string_p(flow_eval,8,1);
+			lcd_fb_string(adc_eval,0,2);
+			lcd_fb_string(flow_eval,8,1);
+			menu_tick();
+			if (!menu_active()) {
+				lcd_wg_bar(adc_results[PRESS_CH], 1023, 0, 3, 20);
+			}
+			trend_sec = trend_sec+1;
+			if (trend_sec>=TREND_SEC) { // only changed glyph rows are written
+				trend_sec = 0;
+				lcd_wg_spark_add(&trend_press, adc_results[PRESS_CH], 1023);
+				// no negative flow if the total was reset in between
+				lcd_wg_spark_add(&trend_flow, total_flow > trend_total ? total_flow-trend_total : 0, TREND_FLOW_MAX);
+				trend_total = total_flow;
+			}
+			lcd_fb_flush(); // only the changed chars
 			update_lcd=0;
+			sup_beat(TASK_DISPLAY);
 		}
+		sup_check(); // watchdog only with all heartbeats
 	}
 	return 0;
 }
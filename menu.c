@@ -0,0 +1,230 @@
+/*************************************************************************
+Title:		Key menu
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		menu.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 4x20 via lcd-fb
+Description:	Table driven menu on one LCD line, operated with one key
+Usage:		see menu.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <stdlib.h>
+	#include <avr/pgmspace.h>
+	#include "menu.h"
+	#include "lcd-fb.h"
+	#include "my-routines.h"
+
+#define MENU_CLOSED			0
+#define MENU_BROWSE			1
+#define MENU_EDITING		2
+
+#define MENU_VALUE_COL		(MENU_LABEL_LEN + 1)
+
+static const menu_item_t *menu_items;	// table in PROGMEM
+static uint8_t menu_n;
+static uint8_t menu_line;
+static uint8_t menu_pos;				// shown item
+static uint8_t menu_state;
+static uint8_t menu_idle;				// seconds since the last key
+static uint16_t menu_edit;				// value while editing
+static menu_item_t menu_it;				// copy of the shown item
+static uint8_t menu_held;				// key still held since the edit start
+
+/*************************************************************************
+Function: menu_draw()
+Purpose:  Put the menu line into the framebuffer
+Input:    none
+Returns:  none
+**************************************************************************/
+static void menu_draw(void)
+{
+	char line[LCD_FB_COLS+1];
+	const char *p;
+	int32_t value;
+	uint8_t i;
+	char c;
+
+	p = menu_it.label;
+	for (i = 0; i < LCD_FB_COLS; i++) {
+		c = ' ';
+		if (p && i < MENU_LABEL_LEN) {
+			c = pgm_read_byte(p++);
+			if (c == '\0') {
+				c = ' ';
+				p = NULL;
+			}
+		}
+		line[i] = c;
+	}
+	line[LCD_FB_COLS] = '\0';
+
+	if (menu_it.type != MENU_ACTION) {
+		if (menu_state == MENU_EDITING) {
+			line[MENU_LABEL_LEN] = '>';
+			value = menu_edit;
+		}
+		else if (menu_it.type == MENU_EDIT) {
+			value = *(uint16_t *)menu_it.value;
+		}
+		else {
+			value = *(int32_t *)menu_it.value;
+		}
+		my_fix_str(&line[MENU_VALUE_COL], LCD_FB_COLS - MENU_VALUE_COL + 1,
+				   value, menu_it.scale, menu_it.scale, LCD_FB_COLS - MENU_VALUE_COL);
+	}
+	lcd_fb_string(line, 0, menu_line);
+}
+
+/*************************************************************************
+Function: menu_show()
+Purpose:  Load an item from the table and draw it
+Input:    item
+Returns:  none
+**************************************************************************/
+static void menu_show(uint8_t pos)
+{
+	menu_pos = pos;
+	memcpy_P(&menu_it, &menu_items[pos], sizeof(menu_it));
+	menu_draw();
+}
+
+/*************************************************************************
+Function: menu_close()
+Purpose:  Close the menu and blank its line
+Input:    none
+Returns:  none
+**************************************************************************/
+static void menu_close(void)
+{
+	uint8_t i;
+
+	menu_state = MENU_CLOSED;
+	for (i = 0; i < LCD_FB_COLS; i++) {
+		lcd_fb_putc(' ', i, menu_line);
+	}
+}
+
+/*************************************************************************
+Function: menu_store()
+Purpose:  Store the edited value and go back to browsing
+Input:    none
+Returns:  none
+**************************************************************************/
+static void menu_store(void)
+{
+	*(uint16_t *)menu_it.value = menu_edit;
+	if (menu_it.func) {
+		menu_it.func();
+	}
+	menu_state = MENU_BROWSE;
+}
+
+/*************************************************************************
+Function: menu_init()
+Purpose:  Set the item table
+Input:    table in PROGMEM, number of items, LCD line
+Returns:  none
+**************************************************************************/
+void menu_init(const menu_item_t *items, uint8_t n, uint8_t line)
+{
+	menu_items = items;
+	menu_n = n;
+	menu_line = line;
+	menu_state = MENU_CLOSED;
+}
+
+/*************************************************************************
+Function: menu_key()
+Purpose:  Handle a key event
+Input:    MENU_KEY_SHORT, MENU_KEY_LONG or MENU_KEY_RPT
+Returns:  none
+**************************************************************************/
+void menu_key(uint8_t key)
+{
+	uint16_t v;
+
+	if (menu_n == 0) {
+		return;
+	}
+	menu_idle = 0;
+	switch (menu_state) {
+	case MENU_CLOSED:
+		if (key == MENU_KEY_SHORT) {
+			menu_state = MENU_BROWSE;
+			menu_show(0);
+		}
+		break;
+	case MENU_BROWSE:
+		if (key == MENU_KEY_SHORT) {
+			if (menu_pos+1 < menu_n) {
+				menu_show(menu_pos+1);
+			}
+			else {
+				menu_close();
+			}
+		}
+		else if (key == MENU_KEY_LONG) {
+			if (menu_it.type == MENU_EDIT) {
+				menu_edit = *(uint16_t *)menu_it.value;
+				menu_state = MENU_EDITING;
+				menu_held = 1;
+			}
+			else if (menu_it.type == MENU_ACTION && menu_it.func) {
+				menu_it.func();
+			}
+			menu_draw();
+		}
+		break;
+	case MENU_EDITING:
+		// the repeats of the long press that started the edit don't count,
+		// a new press ends with SHORT or begins with LONG
+		if (key != MENU_KEY_RPT) {
+			menu_held = 0;
+		}
+		else if (menu_held) {
+			break;
+		}
+		v = menu_edit + menu_it.step;
+		if (v > menu_it.max || v < menu_edit) {
+			v = menu_it.min;
+		}
+		menu_edit = v;
+		menu_draw();
+		break;
+	}
+}
+
+/*************************************************************************
+Function: menu_tick()
+Purpose:  Refresh the value, store an edit and close after a timeout
+Input:    none
+Returns:  none
+**************************************************************************/
+void menu_tick(void)
+{
+	if (menu_state == MENU_CLOSED) {
+		return;
+	}
+	menu_idle++;
+	if (menu_state == MENU_EDITING) {
+		if (menu_idle >= MENU_EDIT_TIME) {
+			menu_store();
+		}
+	}
+	else if (menu_idle >= MENU_CLOSE_TIME) {
+		menu_close();
+		return;
+	}
+	menu_draw();
+}
+
+/*************************************************************************
+Function: menu_active()
+Purpose:  Menu is shown
+Input:    none
+Returns:  true if the menu owns its line
+**************************************************************************/
+uint8_t menu_active(void)
+{
+	return menu_state != MENU_CLOSED;
+}
@@ -0,0 +1,118 @@
+/*************************************************************************
+Title:		Key menu
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		menu.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, HD44780 4x20 via lcd-fb
+Description: 	Table driven menu on one LCD line, operated with one key
+Usage:
+*************************************************************************/
+
+#ifndef MENU_H
+	#define MENU_H
+
+/**
+ *  @defgroup moe_MENU Key menu
+ *  @code #include <menu.h> @endcode
+ *
+ *  @brief Menu from a PROGMEM table, driven by short/long/repeat presses
+ *
+ *	The items are kept in flash. The menu uses one line of the framebuffer
+ *	(label in column 0..9, value in column 11..19), so a key press only
+ *	sends the changed chars and never blocks the main loop.
+ *
+ *	Keys:
+ *	- closed:  short press opens the first item
+ *	- browse:  short press shows the next item, behind the last item the
+ *	           menu is closed; long press selects the item (edit a value
+ *	           or run an action)
+ *	- edit:    short press adds step, held key (long and repeat) adds
+ *	           step every repeat; above max the value wraps to min. The
+ *	           repeats of the long press that selected the value are
+ *	           ignored until the key is pressed again. The
+ *	           value is stored MENU_EDIT_TIME seconds after the last key.
+ *	The menu is closed MENU_CLOSE_TIME seconds after the last key.
+ *
+ *	@code
+ *	static const char l_total[] PROGMEM = "Total m3";
+ *	static const menu_item_t items[] PROGMEM = {
+ *		{ l_total, MENU_VIEW, 3, &total_flow, 0, 0, 0, NULL },
+ *	};
+ *	menu_init(items, 1, 3);
+ *	...
+ *	if (get_key_short(1<<KEY1)) menu_key(MENU_KEY_SHORT);
+ *	...
+ *	menu_tick();						// every second
+ *	lcd_fb_flush();
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define MENU_KEY_SHORT		1		// key released before the long time
+#define MENU_KEY_LONG		2		// key held for the long time
+#define MENU_KEY_RPT		3		// key still held, repeat
+
+#define MENU_VIEW			0		// show an int32_t
+#define MENU_EDIT			1		// edit an uint16_t, func stores it
+#define MENU_ACTION			2		// func on long press
+
+#define MENU_LABEL_LEN		10		// chars of a label
+#define MENU_EDIT_TIME		3		// s without key until an edit is stored
+#define MENU_CLOSE_TIME		30		// s without key until the menu closes
+
+/** @brief One menu item, kept in PROGMEM */
+typedef struct {
+	const char *label;				// PROGMEM string
+	uint8_t type;					// MENU_VIEW, MENU_EDIT, MENU_ACTION
+	uint8_t scale;					// decimal places of the value
+	void *value;					// int32_t (view) or uint16_t (edit)
+	uint16_t min;					// edit range and step
+	uint16_t max;
+	uint16_t step;
+	void (*func)(void);				// action, store after edit or NULL
+} menu_item_t;
+
+/**
+ *	@brief   Set the item table, the menu is closed
+ *
+ *  @param items	Table in PROGMEM
+ *  @param n		Number of items
+ *  @param line		LCD line 1..4 of the menu
+ * 	@return  none
+*/
+void menu_init(const menu_item_t *items, uint8_t n, uint8_t line);
+
+/**
+ *	@brief   Handle a key event and update the menu line
+ *
+ *  @param key	MENU_KEY_SHORT, MENU_KEY_LONG or MENU_KEY_RPT
+ * 	@return  none
+*/
+void menu_key(uint8_t key);
+
+/**
+ *	@brief   Call every second: refresh the value, store and close timeouts
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void menu_tick(void);
+
+/**
+ *	@brief   Menu is shown
+ *
+ *	@param   none
+ * 	@return  true if the menu owns its LCD line
+*/
+uint8_t menu_active(void);
+
+/**@}*/
+
+#endif
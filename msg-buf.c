@@ -0,0 +1,111 @@
+/*************************************************************************
+Title:		Message buffer
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		msg-buf.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description:	Bounded string builder for SMS and UART messages
+Usage:		see msg-buf.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/pgmspace.h>
+	#include "msg-buf.h"
+	#include "my-routines.h"
+
+/*************************************************************************
+Function: msg_init()
+Purpose:  Start a new message
+Input:    message, destination, size of destination
+Returns:  none
+**************************************************************************/
+void msg_init(msg_buf_t *m, char *buf, uint8_t size)
+{
+	m->buf = buf;
+	m->len = 0;
+	m->size = size;
+	m->trunc = 0;
+	buf[0] = '\0';
+}
+
+/*************************************************************************
+Function: msg_putc()
+Purpose:  Append one character
+Input:    message, character
+Returns:  none
+**************************************************************************/
+void msg_putc(msg_buf_t *m, char c)
+{
+	if (m->len < m->size-1) {
+		m->buf[m->len++] = c;
+		m->buf[m->len] = '\0';
+	}
+	else {
+		m->trunc = 1;
+	}
+}
+
+/*************************************************************************
+Function: msg_puts()
+Purpose:  Append a string from SRAM
+Input:    message, string
+Returns:  none
+**************************************************************************/
+void msg_puts(msg_buf_t *m, const char *s)
+{
+	char *p = m->buf + m->len;
+	uint8_t free = m->size-1 - m->len;
+
+	while (*s) {
+		if (free == 0) {
+			m->trunc = 1;
+			break;
+		}
+		*p++ = *s++;
+		free--;
+	}
+	*p = '\0';
+	m->len = p - m->buf;
+}
+
+/*************************************************************************
+Function: msg_puts_p()
+Purpose:  Append a string from flash
+Input:    message, string in program memory
+Returns:  none
+**************************************************************************/
+void msg_puts_p(msg_buf_t *m, const char *s)
+{
+	char *p = m->buf + m->len;
+	uint8_t free = m->size-1 - m->len;
+	char c;
+
+	while ((c = pgm_read_byte(s++))) {
+		if (free == 0) {
+			m->trunc = 1;
+			break;
+		}
+		*p++ = c;
+		free--;
+	}
+	*p = '\0';
+	m->len = p - m->buf;
+}
+
+/*************************************************************************
+Function: msg_fixed()
+Purpose:  Append a fixed point value
+Input:    message, value, number of decimal places
+Returns:  none
+**************************************************************************/
+void msg_fixed(msg_buf_t *m, int32_t value, uint8_t frac)
+{
+	uint8_t n;
+
+	// Format directly behind the actual text
+	n = my_fix_str(m->buf + m->len, m->size - m->len, value, frac, frac, 0);
+	if (n >= m->size - m->len) {
+		m->trunc = 1;
+		n = m->size-1 - m->len;
+	}
+	m->len += n;
+}
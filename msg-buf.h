@@ -0,0 +1,108 @@
+/*************************************************************************
+Title:		Message buffer
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		msg-buf.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description: 	Bounded string builder for SMS and UART messages
+Usage:
+*************************************************************************/
+
+#ifndef MSG_BUF_H
+	#define MSG_BUF_H
+
+/**
+ *  @defgroup moe_MSG Message buffer
+ *  @code #include <msg-buf.h> @endcode
+ *
+ *  @brief Bounded string builder
+ *
+ *	The builder keeps the write position and the size of the
+ *	destination, so every append is O(length of the appended text)
+ *	instead of strcat() rescanning the whole message.
+ *	The text is always terminated, text which does not fit is dropped
+ *	and the trunc flag is set.
+ *	Constant text is read directly from flash (msg_puts_P).
+ *
+ *	@code
+ *	char sms[SMS_MSG_LEN];
+ *	msg_buf_t m;
+ *	msg_init(&m, sms, sizeof(sms));
+ *	msg_puts_P(&m, "Bat: ");
+ *	msg_fixed(&m, 1234, 2);		// "12.34"
+ *	msg_putc(&m, 'V');
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/** @brief State of one message */
+typedef struct {
+	char *buf;			// destination
+	uint8_t len;		// current length without '\0'
+	uint8_t size;		// size of destination including '\0'
+	uint8_t trunc;		// 1 ... text was dropped
+} msg_buf_t;
+
+/**
+ *	@brief   Start a new message in buf
+ *
+ *  @param m 	Message
+ *  @param buf	Destination
+ *  @param size	Size of destination including '\0' (1..255)
+ * 	@return  none
+*/
+void msg_init(msg_buf_t *m, char *buf, uint8_t size);
+
+/**
+ *	@brief   Append one character
+ *
+ *  @param m 	Message
+ *  @param c	Character
+ * 	@return  none
+*/
+void msg_putc(msg_buf_t *m, char c);
+
+/**
+ *	@brief   Append a string from SRAM
+ *
+ *  @param m 	Message
+ *  @param s	String
+ * 	@return  none
+*/
+void msg_puts(msg_buf_t *m, const char *s);
+
+/**
+ *	@brief   Append a string from flash
+ *
+ *  @param m 	Message
+ *  @param s	String in program memory
+ * 	@return  none
+ *	@see msg_puts_P
+*/
+void msg_puts_p(msg_buf_t *m, const char *s);
+
+/**
+ * @brief    Macro to automatically put a string constant into program memory
+ */
+#define msg_puts_P(__m,__s)		msg_puts_p(__m, PSTR(__s))
+
+/**
+ *	@brief   Append a fixed point value
+ *
+ *	The value is printed without leading zeros or spaces,
+ *	e.g. value=-1234, frac=2 => "-12.34", value=5, frac=2 => "0.05"
+ *
+ *  @param m 	Message
+ *  @param value	Fixed point value
+ *  @param frac	Number of decimal places of value
+ * 	@return  none
+*/
+void msg_fixed(msg_buf_t *m, int32_t value, uint8_t frac);
+
+/**@}*/
+
+#endif
@@ -8,12 +8,21 @@ Description:	ADC-Library with variable reference voltage and automatic
 				adjust of ADC-Clock (ADPS-Pins) for system Clock 1 - 20 MHz
 Usage:			AREF - Voltage reference for adc: 1->5V ; 0->2,56V
 *************************************************************************/
-	#include <avr/io.h>
+	#include <stdint.h>
 	#include <stdlib.h>
 	#include <string.h>
 	#include "my-routines.h"
+	#include "num-conv.h"
+#ifdef __AVR__
+	#include <avr/io.h>
+	#include <avr/pgmspace.h>
 	#include "lcd-routines.h"
 	#include "uart.h"
+	#include "at-parser.h"
+	#include "msg-buf.h"
+	#include "soft-clock.h"
+	#include "calendar.h"
+#endif
 /*************************************************************************
 Function: my_string()
 Purpose:  Convert a char to a string
@@ -70,19 +79,18 @@ Input:    signed 32-bit number, string
 Returns:  none
 **************************************************************************/
 void my_itoa(int32_t number, char* string) {
-  uint8_t i;
+  uint32_t value;
  
   string[11]='\0';                  // String Terminator
   if( number < 0 ) {                  // ist die Zahl negativ?
     string[0] = '-';              
-    number = -number;
+    value = -(uint32_t)number;
   }
-  else string[0] = ' ';             // Zahl ist positiv
- 
-  for(i=10; i>=1; i--) {
-    string[i]=(number % 10) +'0';     // Modulo rechnen, dann den ASCII-Code von '0' addieren
-    number /= 10;
+  else {
+    string[0] = ' ';                // Zahl ist positiv
+    value = number;
   }
+  num_u32_dec(string+1, value, 10);   // 10 Stellen ohne Division
 }
 
 /*************************************************************************
@@ -92,19 +100,18 @@ Input:    signed 64-bit number, string
 Returns:  none
 **************************************************************************/
 void my_lltoa(int64_t number, char* string) {
-  uint8_t i;
+  uint64_t value;
  
   string[21]='\0';                  // String Terminator
   if( number < 0 ) {                  // ist die Zahl negativ?
     string[0] = '-';              
-    number = -number;
+    value = -(uint64_t)number;
   }
-  else string[0] = ' ';             // Zahl ist positiv
- 
-  for(i=20; i>=1; i--) {
-    string[i]=(number % 10) +'0';     // Modulo rechnen, dann den ASCII-Code von '0' addieren
-    number /= 10;
+  else {
+    string[0] = ' ';                // Zahl ist positiv
+    value = number;
   }
+  num_u64_dec(string+1, value, 20);   // 20 Stellen ohne Division
 }
 
 /*************************************************************************
@@ -114,7 +121,7 @@ Input:    signed or unsigned string, digit
 Returns:  none
 **************************************************************************/ 
 void my_round(char* string, uint8_t digit) {
-  uint8_t i;
+  int8_t i;
   //Funktionsaufruf : my_round(my_string+1, 5);
  
   if (string[digit]>='5') {         // Aufrunden?
@@ -130,6 +137,7 @@ void my_round(char* string, uint8_t digit) {
   for(i=digit; i<12; i++) string[i] ='0';   // gerundete Stellen auf Null setzen
 }
 
+#ifdef __AVR__
 /*************************************************************************
 Function: my_print_LCD()
 Purpose:  Routine sends a string with a defined format to LCD
@@ -321,6 +329,131 @@ void my_print_UART(char* string, uint8_t start, uint8_t comma, uint8_t frac) {
 		for(; i<(comma+frac); i++) uart_putc(string[i]);
 	}
 }
+#endif // __AVR__, the fixed point format is also built on the host (fix-check.c)
+
+/*************************************************************************
+Function: my_fix_out()
+Purpose:  Format a fixed point value in a single pass
+Input:    destination string and size or put-routine, value, scale,
+		  frac, width
+Returns:  length of the complete text
+**************************************************************************/
+// Write one char to the string (cut off at size) or to the put-routine
+#define MY_FIX_PUT(c)	do { if (dst) { if (n < size-1) dst[n] = (c); } else put(c); n++; } while (0)
+
+static uint8_t my_fix_out(char* dst, uint8_t size, void (*put)(unsigned char),
+		int32_t value, uint8_t scale, uint8_t frac, uint8_t width) {
+	/* Example: value=25806528, scale=7, frac=1, width=4 => " 2.6"
+		value	raw number, value/10^scale is the real number
+		frac	decimal places of the text, rounded
+		width	minimum length of the text, padded with spaces */
+	uint32_t number;
+	uint32_t p10;
+	uint8_t neg = 0;
+	uint8_t top;		// highest digit position
+	uint8_t low;		// lowest printed digit position
+	uint8_t zeros = 0;	// zeros appended if frac>scale
+	uint8_t len;
+	uint8_t n = 0;		// chars written
+	int8_t k;
+	char c;
+
+	if (scale > 9) scale = 9;
+	if (frac > 9) frac = 9;
+
+	if (value < 0) {
+		neg = 1;
+		number = -(uint32_t)value;
+	}
+	else {
+		number = value;
+	}
+
+	// Round at the last printed digit
+	if (frac < scale) {
+		low = scale - frac;
+		number += 5 * num_pow10(low-1);
+	}
+	else {
+		low = 0;
+		zeros = frac - scale;
+	}
+
+	// Number of digits, at least one digit before the comma
+	top = 9;
+	while ((top > scale) && (number < num_pow10(top))) top--;
+	if (number < num_pow10(low)) {
+		neg = 0;		// no "-0.0"
+	}
+
+	len = neg + (top - low + 1) + zeros + (frac ? 1 : 0);
+
+	// Padding and sign
+	for (k = len; k < width; k++) {
+		MY_FIX_PUT(' ');
+	}
+	if (neg) {
+		MY_FIX_PUT('-');
+	}
+
+	// Digits from left to right by subtraction of the powers of ten
+	for (k = top; k >= (int8_t)low; k--) {
+		if ((k == (int8_t)scale-1) && (frac != 0)) {
+			MY_FIX_PUT('.');
+		}
+		p10 = num_pow10(k);
+		c = '0';
+		while (number >= p10) {
+			number -= p10;
+			c++;
+		}
+		MY_FIX_PUT(c);
+	}
+	if (zeros) {
+		if (scale == 0) {			// comma was not printed in the loop
+			MY_FIX_PUT('.');
+		}
+		while (zeros--) {
+			MY_FIX_PUT('0');
+		}
+	}
+	if (dst) {
+		dst[(n < size) ? n : size-1] = '\0';
+	}
+	return n;
+}
+#undef MY_FIX_PUT
+
+/*************************************************************************
+Function: my_fix_str()
+Purpose:  Format a fixed point value to a string
+Input:    destination, size of destination, value, scale, frac, width
+Returns:  length of the complete text, >= size if text was cut off
+**************************************************************************/
+uint8_t my_fix_str(char* dst, uint8_t size, int32_t value, uint8_t scale, uint8_t frac, uint8_t width) {
+	return my_fix_out(dst, size, 0, value, scale, frac, width);
+}
+
+#ifdef __AVR__
+/*************************************************************************
+Function: my_fix_UART()
+Purpose:  Send a fixed point value to UART
+Input:    value, scale, frac, width
+Returns:  none
+**************************************************************************/
+void my_fix_UART(int32_t value, uint8_t scale, uint8_t frac, uint8_t width) {
+	my_fix_out(0, 0, uart_putc, value, scale, frac, width);
+}
+
+/*************************************************************************
+Function: my_fix_LCD()
+Purpose:  Send a fixed point value to LCD
+Input:    value, scale, frac, width
+Returns:  none
+**************************************************************************/
+void my_fix_LCD(int32_t value, uint8_t scale, uint8_t frac, uint8_t width) {
+	my_fix_out(0, 0, lcd_data, value, scale, frac, width);
+}
 /*************************************************************************
 Function: nr_str()
 Purpose:  Routine sends a string with a defined format to UART
@@ -352,228 +485,34 @@ void nr_str(char* string, char* str_new, uint8_t nr_new, uint8_t start_pos, uint
 	nr_new = (uint8_t)temp;
 }
 
-uint8_t SIM900_AT_CSQ(char* sig_qual, char* csq_str, uint8_t gsm_rssi) {
-	/*
-		https://www.lte-anbieter.info/Bilder/technik/empfang/asu-2g.png
-		
-		Value	RSSI	Strength	
-		[-]		[dBm]	[%]
-		0		-113	0
-		1		-111	3
-		2		-109	6	
-		3		-107	10	
-		4		-105	13
-		5		-103	16
-		6		-101	19
-		7		-99		23
-		8		-97		26
-		9		-95		29
-		10		-93		32
-		11		-91		35
-		12		-89		39
-		13		-87		42
-		14		-85		45
-		15		-83		48
-		16		-81		52
-		17		-79		55
-		18		-77		58
-		19		-75		61
-		20		-73		65
-		21		-71		68
-		22		-69		71
-		23		-67		74
-		24		-65		77
-		25		-63		81
-		26		-61		84
-		27		-59		87
-		28		-57		90
-		29		-55		94
-		30		-53		97
-		31		-51		100
-		*/
-  uint8_t i=0;            // Zhler
-  uint8_t j=0;
-  uint8_t start=0;
-  uint8_t end=0;
-  int8_t value=0;
-  sig_qual[0] = '\0';
-  uint8_t sig_nr=0;
-  
-// Extract number
-    for(i=5; i<=10; i++) {
-		if (csq_str[i]==' ') {
-			start=i+1;
-		}
-		if (csq_str[i]==',') {
-			end = i-1;
-			break;
-		}
-	}
-	j=0;
-	for(i=start; i<=end; i++) {
-		sig_qual[j]=csq_str[i];
-         j++;
-	}
-    sig_qual[j] = '\0';
-	
-// Change string to number
-	value=atoi(sig_qual);
-	gsm_rssi = value;
-	
-// Convert to signal strength
-	switch (value) {
-		case 0:
-			strcpy( sig_qual, "0" );
-			sig_nr = 0;
-			break;
-		case 1:
-			strcpy( sig_qual, "3" );
-			sig_nr = 1;
-			break;
-		case 2:
-			strcpy( sig_qual, "6" );
-			sig_nr = 1;
-			break;
-		case 3:
-			strcpy( sig_qual, "10" );
-			sig_nr = 1;
-			break;
-		case 4: 
-			strcpy( sig_qual, "13" );
-			sig_nr = 1;
-			break;
-		case 5: 
-			strcpy( sig_qual, "16" );
-			sig_nr = 1;
-			break;
-		case 6: 
-			strcpy( sig_qual, "19" );
-			sig_nr = 1;
-			break;
-		case 7: 
-			strcpy( sig_qual, "23" );
-			sig_nr = 2;
-			break;
-		case 8: 
-			strcpy( sig_qual, "26" );
-			sig_nr = 2;
-			break;
-		case 9: 
-			strcpy( sig_qual, "29" );
-			sig_nr = 2;
-			break;
-		case 10: 
-			strcpy( sig_qual, "32" );
-			sig_nr = 2;
-			break;
-		case 11: 
-			strcpy( sig_qual, "35" );
-			sig_nr = 2;
-			break;
-		case 12: 
-			strcpy( sig_qual, "39" );
-			sig_nr = 2;
-			break;
-		case 13: 
-			strcpy( sig_qual, "42" );
-			sig_nr = 3;
-			break;
-		case 14: 
-			strcpy( sig_qual, "45" );
-			sig_nr = 3;
-			break;
-		case 15: 
-			strcpy( sig_qual, "48" );
-			sig_nr = 3;
-			break;
-		case 16: 
-			strcpy( sig_qual, "52" );
-			sig_nr = 3;
-			break;
-		case 17: 
-			strcpy( sig_qual, "55" );
-			sig_nr = 3;
-			break;
-		case 18: 
-			strcpy( sig_qual, "58" );
-			sig_nr = 3;
-			break;
-		case 19: 
-			strcpy( sig_qual, "61" );
-			sig_nr = 4;
-			break;
-		case 20: 
-			strcpy( sig_qual, "65" );
-			sig_nr = 4;
-			break;
-		case 21: 
-			strcpy( sig_qual, "68" );
-			sig_nr = 4;	
-			break;		
-		case 22: 
-			strcpy( sig_qual, "71" );
-			sig_nr = 4;
-			break;
-		case 23: 
-			strcpy( sig_qual, "74" );
-			sig_nr = 4;
-			break;
-		case 24: 
-			strcpy( sig_qual, "77" );
-			sig_nr = 4;
-			break;
-		case 25: 
-			strcpy( sig_qual, "81" );
-			sig_nr = 4;
-			break;
-		case 26: 
-			strcpy( sig_qual, "84" );
-			sig_nr = 4;
-			break;
-		case 27: 
-			strcpy( sig_qual, "87" );
-			sig_nr = 5;
-			break;
-		case 28: 
-			strcpy( sig_qual, "90" );
-			sig_nr = 5;
-			break;
-		case 29: 
-			strcpy( sig_qual, "94" );
-			sig_nr = 5;
-			break;
-		case 30: 
-			strcpy( sig_qual, "97" );
-			sig_nr = 5;
-			break;
-		case 31: 
-			strcpy( sig_qual, "100" );
-			sig_nr = 5;
-			break;
+/*************************************************************************
+Function: SIM900_AT_CSQ()
+Purpose:  Evaluate the answer of AT+CSQ, e.g. "+CSQ: 23,0"
+Input:    string for signal strength [%], response of at_parse_char()
+Returns:  signal bars 0..5
+**************************************************************************/
+uint8_t SIM900_AT_CSQ(char* sig_qual, const at_resp_t *r) {
+	if ((r->type != AT_RESP_CSQ) || (r->n_int == 0)) {
+		sig_qual[0] = '\0';
+		return 0;
 	}
-	return sig_nr;
+	// Signal strength and bars from PROGMEM-table, see at-parser.c
+	utoa(at_rssi_percent(r->val[0]), sig_qual, 10);
+	return at_rssi_bars(r->val[0]);
 }
 
-
-void SIM900_AT_CREG(signed char gsm_reg, char* gsm_return) {
-  uint8_t i=0;            // Zhler
-  uint8_t start=0;
-  char reg_str[2];
-  int8_t val;
-
-// Extract number
-    for(i=8; i<=10; i++) {
-		if (gsm_return[i]==',') {
-			start=i+1;
-			break;
-		}
+/*************************************************************************
+Function: SIM900_AT_CREG()
+Purpose:  Evaluate the answer of AT+CREG?, e.g. "+CREG: 0,1"
+Input:    response of at_parse_char()
+Returns:  registration state, -1 if not a +CREG answer
+**************************************************************************/
+signed char SIM900_AT_CREG(const at_resp_t *r) {
+	if ((r->type != AT_RESP_CREG) || (r->n_int == 0)) {
+		return -1;
 	}
-	reg_str[0]=gsm_return[start];
-	reg_str[1]='\0';
-	
-// Change string to number
-	val=atoi(reg_str);
-	gsm_reg = val;
+	// <stat> is the last field: "+CREG: <n>,<stat>" or "+CREG: <stat>"
+	return r->val[r->n_int-1];
 }
 
 unsigned char my_wait(unsigned char time, unsigned char sec) {
@@ -621,88 +560,68 @@ void my_print_time(unsigned char hour, unsigned char min,unsigned char sec, char
 		str_time[5] = '\0';
 	}
 }
-void SIM900_AT_CMTI(signed char sms_nr, char* sms_str, char* gsm_return) {
-  int8_t val;
-// Extract number, start with 12, check if number greater than 9
-	if (gsm_return[14]!='\0') {
-		sms_str[0] = gsm_return[12];
-		sms_str[1] = gsm_return[13];
-		sms_str[2] = gsm_return[14];
-		sms_str[3] = '\0';
-		}
-	else if (gsm_return[13]!='\0') {
-		sms_str[0] = gsm_return[12];
-		sms_str[1] = gsm_return[13];
-		sms_str[2] = '\0';
-		}
-	else {
-		sms_str[0] = gsm_return[12];
-		sms_str[1] = '\0';
-		}
-	
-// Change string to number
-	val=atoi(sms_str);
-	sms_nr = val;
-}
-void SIM900_AT_CMGR(char* sms_phone_nr, char* gsm_return) {
-  uint8_t i=0;            // Zhler
-  uint8_t j=0;
-  uint8_t start=0;
-// +CMGR: "REC UNREAD","+436644233412","","19/12/27,12:00:21+04"<\r><\n>
-	// Start of number
-    for(i=10; i<=40; i++) {
-		if (gsm_return[i]=='+') {
-			start=i;
-			break;
-		}
+/*************************************************************************
+Function: SIM900_AT_CMTI()
+Purpose:  Evaluate the message indication, e.g. +CMTI: "SM",12
+Input:    string of the number, response of at_parse_char()
+Returns:  number of SMS, -1 if not a +CMTI indication
+**************************************************************************/
+signed char SIM900_AT_CMTI(char* sms_str, const at_resp_t *r) {
+	if ((r->type != AT_RESP_CMTI) || (r->n_int == 0)) {
+		sms_str[0] = '\0';
+		return -1;
 	}
-	// Start Copy String
-	j=0;
-	for(i=start; i<=100; i++) {
-		if (gsm_return[i]==0x22) {
-			sms_phone_nr[j]='\0';
-			break;
-		}
-		else {
-			sms_phone_nr[j]= gsm_return[i];
-		}
-		j=j+1;
+	itoa(r->val[0], sms_str, 10);
+	return r->val[0];
+}
+/*************************************************************************
+Function: SIM900_AT_CMGR()
+Purpose:  Extract the phone number of AT+CMGR
+		  +CMGR: "REC UNREAD","+436644233412","","19/12/27,12:00:21+04"
+Input:    string for phone number and its size, response of at_parse_char()
+Returns:  none
+**************************************************************************/
+void SIM900_AT_CMGR(char* sms_phone_nr, uint8_t size, const at_resp_t *r) {
+	sms_phone_nr[0] = '\0';
+	if ((r->type == AT_RESP_CMGR) && (r->n_str > 1)) {
+		strncpy(sms_phone_nr, r->str[1], size-1);	// cut off at size
+		sms_phone_nr[size-1] = '\0';
 	}
 }
-void SIM900_SMS_Status(char alarm, char* str_AL, char*str_vgrid, char* str_vbatt, char* str_alarm_time, char* str_time, char* sms_msg_status) {
-	//char str_alarm[2];
-	//int8_t i;
-	//uint8_t AL_nr;						// schleifenzhler
-	char str_batt[12];
-	char str_grid[12];
+/*************************************************************************
+Function: SIM900_SMS_stamp()
+Purpose:  Append a time stamp as YYYY-MM-DD hh:mm:ss
+Input:    message, seconds since 1970-01-01
+Returns:  none
+**************************************************************************/
+static void SIM900_SMS_stamp(msg_buf_t *msg, uint32_t stamp) {
+	clk_time_t t;
+	char s[CAL_DATE_LEN + 1];
+
+	cal_from_unix(stamp, &t);
+	msg_puts(msg, cal_format_date(s, &t));
+	msg_putc(msg, ' ');
+	msg_puts(msg, cal_format_time(s, &t));
+}
+void SIM900_SMS_Status(char alarm, char* str_AL, int32_t vgrid, int32_t vbatt, uint32_t alarm_time, uint32_t now, char* sms_msg_status) {
+	msg_buf_t msg;
 
+	// sms_msg_status has to hold SMS_MSG_LEN chars, longer text is cut off
+	msg_init(&msg, sms_msg_status, SMS_MSG_LEN);
 	if (alarm==0) {
-	
-	
-		my_print_str(str_vbatt, 4, 6, 1, 0,str_batt);
-		my_print_str(str_vgrid, 4, 6, 1, 0,str_grid);
-		strcpy(sms_msg_status, "sim900 bereit");
-		strcat(sms_msg_status, " @ ");
-		strcat(sms_msg_status, str_time);
-		strcat(sms_msg_status, "; Bat: ");
-		strcat(sms_msg_status, str_batt);
-		strcat(sms_msg_status, "V; Netz: ");
-		strcat(sms_msg_status, str_grid);
-		strcat(sms_msg_status, "V");
+		msg_puts_P(&msg, "sim900 bereit @ ");
+		SIM900_SMS_stamp(&msg, now);
+		msg_puts_P(&msg, "; Bat: ");
+		msg_fixed(&msg, vbatt, 1);		// formatted in place, e.g. "12.6"
+		msg_puts_P(&msg, "V; Netz: ");
+		msg_fixed(&msg, vgrid, 1);
+		msg_putc(&msg, 'V');
 	}
 	else {
-		//strcpy(sms_msg_status, "sim900 ALARM");
-		
-		/*AL_nr = alarm;
-		str_alarm[1]='\0';                       // String Terminator
-		for(i=1; i>=0; i--) {
-			str_alarm[i]=(AL_nr % 10) +'0';         // Modulo rechnen, dann den ASCII-Code von '0' addieren
-			AL_nr /= 10;
-		}*/
-	
-		strcpy(sms_msg_status, "sim900 ALARM Eingang: ");
-		strcat(sms_msg_status, str_AL);
-		strcat(sms_msg_status, " um ");
-		strcat(sms_msg_status, str_alarm_time);
+		msg_puts_P(&msg, "sim900 ALARM Eingang: ");
+		msg_puts(&msg, str_AL);
+		msg_puts_P(&msg, " um ");
+		SIM900_SMS_stamp(&msg, alarm_time);
 	}
-}
\ No newline at end of file
+}
+#endif // __AVR__
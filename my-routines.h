@@ -11,6 +11,9 @@ Usage:
 #ifndef MY_ROUTINES_H
 	#define MY_ROUTINES_H
 
+	#include <stdint.h>
+	#include "at-parser.h"
+
 /** 
  *  @defgroup Common My-Routines
  *  @code #include <my-routines.h> @endcode
@@ -28,6 +31,9 @@ Usage:
  */
  
  /**@{*/
+
+/** @brief Size of a SMS text including '\0', see SIM900_SMS_Status */
+#define SMS_MSG_LEN		161
  
 /**
  *	@brief   Convert a char to a string
@@ -160,17 +166,86 @@ void my_print_str(char* string, uint8_t start, uint8_t comma, uint8_t frac, uint
 */
 void my_print_UART(char* string, uint8_t start, uint8_t comma, uint8_t frac); 
 
+/**
+ *	@brief   Format a fixed point value to a string
+ *
+ *	Single pass replacement of my_itoa/my_round/my_print_str.
+ *	The value is rounded to frac decimal places and right aligned
+ *	to width chars, the digits are created without division.
+ *	value=25806528, scale=7, frac=1, width=4 => " 2.6"
+ *	value=1, scale=3, frac=3, width=6 => " 0.001"
+ *
+ *  @param dst		Destination
+ *  @param size		Size of destination including '\0'
+ *  @param value	Fixed point value, value/10^scale is the real number
+ *  @param scale	Decimal places of value (0..9)
+ *  @param frac		Decimal places of the text (0..9)
+ *  @param width	Minimum length of the text, padded with spaces
+ * 	@return  Length of the complete text, >= size if the text was cut off
+ *	@see my_fix_UART
+ *	@see my_fix_LCD
+*/
+uint8_t my_fix_str(char* dst, uint8_t size, int32_t value, uint8_t scale, uint8_t frac, uint8_t width);
+
+/**
+ *	@brief   Send a fixed point value to the UART ringbuffer
+ *
+ *	Same format as my_fix_str, the chars are sent directly
+ *
+ *  @param value	Fixed point value, value/10^scale is the real number
+ *  @param scale	Decimal places of value (0..9)
+ *  @param frac		Decimal places of the text (0..9)
+ *  @param width	Minimum length of the text, padded with spaces
+ * 	@return  none
+ *	@see my_fix_str
+*/
+void my_fix_UART(int32_t value, uint8_t scale, uint8_t frac, uint8_t width);
+
+/**
+ *	@brief   Send a fixed point value to the LCD at the actual cursor position
+ *
+ *	Same format as my_fix_str, the chars are sent directly
+ *
+ *  @param value	Fixed point value, value/10^scale is the real number
+ *  @param scale	Decimal places of value (0..9)
+ *  @param frac		Decimal places of the text (0..9)
+ *  @param width	Minimum length of the text, padded with spaces
+ * 	@return  none
+ *	@see my_fix_str
+*/
+void my_fix_LCD(int32_t value, uint8_t scale, uint8_t frac, uint8_t width);
+
 void nr_str(char* string, char* str_new, uint8_t nr_new, uint8_t pos_start, uint8_t pos_end);
 
-uint8_t SIM900_AT_CSQ(char* sig_qual, char*csq_str, uint8_t gsm_rssi);
+/*
+** SIM900 responses, as returned by at_parse_char() (at-parser.h), no
+** copy of the line
+*/
+uint8_t SIM900_AT_CSQ(char* sig_qual, const at_resp_t *r);
 
-void SIM900_AT_CREG(signed char gsm_reg, char* gsm_return);
+signed char SIM900_AT_CREG(const at_resp_t *r);
 
-void SIM900_AT_CMTI(signed char sms_nr, char* sms_str, char* gsm_return);
+signed char SIM900_AT_CMTI(char* sms_str, const at_resp_t *r);
 
-void SIM900_AT_CMGR(char* sms_phone_nr, char* gsm_return);
+void SIM900_AT_CMGR(char* sms_phone_nr, uint8_t size, const at_resp_t *r);
 
-void SIM900_SMS_Status(char alarm, char* str_AL, char* str_vgrid, char* str_vbatt, char* str_alarm_time, char* str_time, char* sms_msg_status);
+/**
+ *	@brief   Compose the status or alarm SMS
+ *
+ *	The text is built with the bounded message buffer (msg-buf.h),
+ *	constant text is read from flash.
+ *
+ *  @param alarm	0 ... status message, else alarm message
+ *  @param str_AL	Alarm input
+ *  @param vgrid	Grid voltage in 0.1V
+ *  @param vbatt	Battery voltage in 0.1V
+ *  @param alarm_time	Time of alarm, seconds since 1970 (clk_now)
+ *  @param now		Actual time, seconds since 1970, both sent as
+ *  				YYYY-MM-DD hh:mm:ss
+ *  @param sms_msg_status	Destination, at least SMS_MSG_LEN chars
+ * 	@return  none
+*/
+void SIM900_SMS_Status(char alarm, char* str_AL, int32_t vgrid, int32_t vbatt, uint32_t alarm_time, uint32_t now, char* sms_msg_status);
 
 extern unsigned char my_wait(unsigned char time, unsigned char sec);
 
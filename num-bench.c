@@ -0,0 +1,112 @@
+/*************************************************************************
+Title:		Number conversion benchmark
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		num-bench.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	ATmega328P, 16MHz
+Description:	Cycles of the _sub and _mul kernels of num-conv, counted
+				by Timer1 (prescaler 1), for the NUM_Uxx_KERNEL choice
+Usage:		avr-gcc -mmcu=atmega328p -DF_CPU=16000000UL -Os -I. -o num-bench.elf
+				num-bench.c num-conv.c uart.c
+			flash it (19200 baud, one line per kernel and value) or run it
+			in simulavr and read num_bench_cyc[] with avr-gdb
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/io.h>
+	#include <avr/interrupt.h>
+	#include "num-conv.h"
+	#include "uart.h"
+
+#define BENCH_BAUD		19200
+#define BENCH_VALUES	3
+
+// per width: 0, most subtractions, maximum
+static const uint16_t bench_u16[BENCH_VALUES] = { 0, 59999U, 65535U };
+static const uint32_t bench_u32[BENCH_VALUES] = { 0, 3999999999UL, 4294967295UL };
+static const uint64_t bench_u64[BENCH_VALUES] = { 0, 9999999999999999999ULL,
+												  18446744073709551615ULL };
+
+volatile uint16_t num_bench_cyc[6][BENCH_VALUES];	// u16 sub, mul, u32 .., u64 ..
+
+static uint16_t bench_t0;				// cycles of an empty measurement
+static char bench_buf[NUM_U64_DIGITS];
+
+// Timer1 from 0, cycles of the call in res, 0xFFFF on overflow
+#define BENCH(res, call) do {					\
+	cli();										\
+	TIFR1 = 1<<TOV1;							\
+	TCNT1 = 0;									\
+	call;										\
+	res = TCNT1;								\
+	if (TIFR1 & (1<<TOV1)) res = 0xFFFF;		\
+	else res -= bench_t0;						\
+	sei();										\
+} while (0)
+
+/*************************************************************************
+Function: bench_print()
+Purpose:  One result line, e.g. "u32 sub 00000000004294967295 01234"
+Input:    kernel, value, cycles
+Returns:  none
+**************************************************************************/
+static void bench_print(const char *name, uint64_t value, uint16_t cyc)
+{
+	char s[NUM_U64_DIGITS + 1];
+
+	uart_puts(name);
+	uart_putc(' ');
+	num_u64_dec_sub(s, value, NUM_U64_DIGITS);
+	s[NUM_U64_DIGITS] = '\0';
+	uart_puts(s);
+	uart_putc(' ');
+	num_u16_dec_sub(s, cyc, NUM_U16_DIGITS);
+	s[NUM_U16_DIGITS] = '\0';
+	uart_puts(s);
+	uart_putc('\n');
+}
+
+int main(void)
+{
+	uint16_t c;
+	uint8_t i;
+
+	TCCR1A = 0;
+	TCCR1B = 1<<CS10;					// prescaler 1: one count per cycle
+	uart_init(UART_BAUD_SELECT(BENCH_BAUD, F_CPU));
+	sei();
+
+	bench_t0 = 0;
+	BENCH(c, ;);
+	bench_t0 = c;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		BENCH(c, num_u16_dec_sub(bench_buf, bench_u16[i], NUM_U16_DIGITS));
+		num_bench_cyc[0][i] = c;
+		BENCH(c, num_u16_dec_mul(bench_buf, bench_u16[i], NUM_U16_DIGITS));
+		num_bench_cyc[1][i] = c;
+		BENCH(c, num_u32_dec_sub(bench_buf, bench_u32[i], NUM_U32_DIGITS));
+		num_bench_cyc[2][i] = c;
+		BENCH(c, num_u32_dec_mul(bench_buf, bench_u32[i], NUM_U32_DIGITS));
+		num_bench_cyc[3][i] = c;
+		BENCH(c, num_u64_dec_sub(bench_buf, bench_u64[i], NUM_U64_DIGITS));
+		num_bench_cyc[4][i] = c;
+		BENCH(c, num_u64_dec_mul(bench_buf, bench_u64[i], NUM_U64_DIGITS));
+		num_bench_cyc[5][i] = c;
+	}
+
+	uart_puts("kernel  value                cycles\n");
+	for (i = 0; i < BENCH_VALUES; i++) {
+		bench_print("u16 sub", bench_u16[i], num_bench_cyc[0][i]);
+		bench_print("u16 mul", bench_u16[i], num_bench_cyc[1][i]);
+	}
+	for (i = 0; i < BENCH_VALUES; i++) {
+		bench_print("u32 sub", bench_u32[i], num_bench_cyc[2][i]);
+		bench_print("u32 mul", bench_u32[i], num_bench_cyc[3][i]);
+	}
+	for (i = 0; i < BENCH_VALUES; i++) {
+		bench_print("u64 sub", bench_u64[i], num_bench_cyc[4][i]);
+		bench_print("u64 mul", bench_u64[i], num_bench_cyc[5][i]);
+	}
+	for (;;)
+		;
+}
@@ -0,0 +1,247 @@
+/*************************************************************************
+Title:		Number conversion
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		num-conv.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description:	Integer to decimal conversion without division
+Usage:		see num-conv.h
+*************************************************************************/
+	#include <stdint.h>
+	#include "num-conv.h"
+#ifdef __AVR__
+	#include <avr/pgmspace.h>
+#else
+	// host build with fix-check.c
+	#include <string.h>
+	#define PROGMEM
+	#define pgm_read_word(p)	(*(p))
+	#define pgm_read_dword(p)	(*(p))
+	#define memcpy_P			memcpy
+#endif
+
+// Powers of ten, 64 bit only down to 10^9, the rest is done in 32 bit
+#define NUM_POW10_64_NR	(NUM_U64_DIGITS - NUM_U32_DIGITS + 1)
+static const uint64_t num_pow10_64[NUM_POW10_64_NR] PROGMEM = {
+	10000000000000000000ULL, 1000000000000000000ULL, 100000000000000000ULL,
+	10000000000000000ULL, 1000000000000000ULL, 100000000000000ULL,
+	10000000000000ULL, 1000000000000ULL, 100000000000ULL, 10000000000ULL,
+	1000000000ULL
+};
+
+static const uint32_t num_pow10_32[NUM_U32_DIGITS] PROGMEM = {
+	1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+	10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+static const uint16_t num_pow10_16[NUM_U16_DIGITS] PROGMEM = {
+	10000U, 1000U, 100U, 10U, 1U
+};
+
+/*************************************************************************
+Function: num_pow10()
+Purpose:  Power of ten
+Input:    exponent 0..9
+Returns:  10^k
+**************************************************************************/
+uint32_t num_pow10(uint8_t k)
+{
+	return pgm_read_dword(&num_pow10_32[NUM_U32_DIGITS-1 - k]);
+}
+
+/*************************************************************************
+Function: num_u16_dec_sub()
+Purpose:  16 bit to decimal, subtract powers of ten
+Input:    destination, value, number of digits
+Returns:  none
+**************************************************************************/
+void num_u16_dec_sub(char *dst, uint16_t value, uint8_t digits)
+{
+	const uint16_t *tab = &num_pow10_16[NUM_U16_DIGITS - digits];
+	uint16_t p10;
+	char c;
+
+	while (digits--) {
+		p10 = pgm_read_word(tab++);
+		c = '0';
+		while (value >= p10) {
+			value -= p10;
+			c++;
+		}
+		*dst++ = c;
+	}
+}
+
+/*************************************************************************
+Function: num_u16_dec_mul()
+Purpose:  16 bit to decimal, multiply by reciprocal
+Input:    destination, value, number of digits
+Returns:  none
+**************************************************************************/
+void num_u16_dec_mul(char *dst, uint16_t value, uint8_t digits)
+{
+	uint16_t q;
+
+	dst += digits;
+	while (digits--) {
+		// value/10 == value*0xCCCD/2^19 for every 16 bit value
+		q = ((uint32_t)value * 0xCCCDU) >> 19;
+		*--dst = '0' + (uint8_t)(value - q*10);
+		value = q;
+	}
+}
+
+/*************************************************************************
+Function: num_u32_dec_sub()
+Purpose:  32 bit to decimal, subtract powers of ten
+Input:    destination, value, number of digits
+Returns:  none
+**************************************************************************/
+void num_u32_dec_sub(char *dst, uint32_t value, uint8_t digits)
+{
+	const uint32_t *tab = &num_pow10_32[NUM_U32_DIGITS - digits];
+	uint32_t p10;
+	char c;
+
+	while (digits--) {
+		p10 = pgm_read_dword(tab++);
+		c = '0';
+		while (value >= p10) {
+			value -= p10;
+			c++;
+		}
+		*dst++ = c;
+	}
+}
+
+/*************************************************************************
+Function: num_u32_dec_mul()
+Purpose:  32 bit to decimal, multiply by reciprocal
+Input:    destination, value, number of digits
+Returns:  none
+**************************************************************************/
+void num_u32_dec_mul(char *dst, uint32_t value, uint8_t digits)
+{
+	uint32_t q, r;
+
+	dst += digits;
+	while (digits--) {
+		// q = value*0.8/8 by shift and add (Hacker's Delight, divu10)
+		q = (value >> 1) + (value >> 2);
+		q += q >> 4;
+		q += q >> 8;
+		q += q >> 16;
+		q >>= 3;
+		r = value - ((q << 3) + (q << 1));
+		if (r > 9) {		// q is at most one too small
+			q++;
+			r -= 10;
+		}
+		*--dst = '0' + (uint8_t)r;
+		value = q;
+	}
+}
+
+/*************************************************************************
+Function: num_u64_dec_sub()
+Purpose:  64 bit to decimal, subtract powers of ten
+Input:    destination, value, number of digits
+Returns:  none
+**************************************************************************/
+void num_u64_dec_sub(char *dst, uint64_t value, uint8_t digits)
+{
+	uint64_t p10;
+	char c;
+
+	// Upper digits in 64 bit, the rest with the 32 bit kernel
+	while (digits > NUM_U32_DIGITS-1) {
+		memcpy_P(&p10, &num_pow10_64[NUM_U64_DIGITS - digits], sizeof(p10));
+		c = '0';
+		while (value >= p10) {
+			value -= p10;
+			c++;
+		}
+		*dst++ = c;
+		digits--;
+	}
+	num_u32_dec_sub(dst, (uint32_t)value, digits);
+}
+
+/*************************************************************************
+Function: num_u64_dec_mul()
+Purpose:  64 bit to decimal, multiply by reciprocal
+Input:    destination, value, number of digits
+Returns:  none
+**************************************************************************/
+void num_u64_dec_mul(char *dst, uint64_t value, uint8_t digits)
+{
+	uint64_t q;
+	uint8_t r;
+
+	dst += digits;
+	// Lower digits in 64 bit until the rest fits into 32 bit
+	while (digits && (value >> 32)) {
+		q = (value >> 1) + (value >> 2);
+		q += q >> 4;
+		q += q >> 8;
+		q += q >> 16;
+		q += q >> 32;
+		q >>= 3;
+		r = (uint8_t)(value - ((q << 3) + (q << 1)));
+		if (r > 9) {
+			q++;
+			r -= 10;
+		}
+		*--dst = '0' + r;
+		value = q;
+		digits--;
+	}
+	num_u32_dec_mul(dst - digits, (uint32_t)value, digits);
+}
+
+/*************************************************************************
+Function: num_u32_len()
+Purpose:  Number of decimal digits
+Input:    value
+Returns:  1..10
+**************************************************************************/
+uint8_t num_u32_len(uint32_t value)
+{
+	uint8_t len = NUM_U32_DIGITS;
+	const uint32_t *tab = num_pow10_32;
+
+	while ((len > 1) && (value < pgm_read_dword(tab++))) {
+		len--;
+	}
+	return len;
+}
+
+/*************************************************************************
+Function: num_u32_str()
+Purpose:  32 bit to string without leading zeros
+Input:    destination, value
+Returns:  length
+**************************************************************************/
+uint8_t num_u32_str(char *dst, uint32_t value)
+{
+	uint8_t len = num_u32_len(value);
+
+	num_u32_dec(dst, value, len);
+	dst[len] = '\0';
+	return len;
+}
+
+/*************************************************************************
+Function: num_i32_str()
+Purpose:  Signed 32 bit to string without leading zeros
+Input:    destination, value
+Returns:  length
+**************************************************************************/
+uint8_t num_i32_str(char *dst, int32_t value)
+{
+	if (value < 0) {
+		*dst = '-';
+		return num_u32_str(dst+1, -(uint32_t)value) + 1;
+	}
+	return num_u32_str(dst, value);
+}
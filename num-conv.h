@@ -0,0 +1,167 @@
+/*************************************************************************
+Title:		Number conversion
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		num-conv.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description: 	Integer to decimal conversion without division
+Usage:
+*************************************************************************/
+
+#ifndef NUM_CONV_H
+	#define NUM_CONV_H
+
+	#include <stdint.h>
+
+/**
+ *  @defgroup moe_NUM Number conversion
+ *  @code #include <num-conv.h> @endcode
+ *
+ *  @brief Division free integer to decimal conversion for 16/32/64 bit
+ *
+ *	The AVR has no divider, every "% 10" and "/ 10" on a 32 or 64 bit
+ *	value is a call of the libgcc division loop. Two kinds of kernels
+ *	are available for every width:
+ *	- _sub: subtract powers of ten (table in flash), digits from left
+ *	  to right, at most 9 subtractions per digit
+ *	- _mul: multiply by the reciprocal of 10 (16 bit: 32 bit product,
+ *	  32/64 bit: shift and add), digits from right to left
+ *
+ *	num_uXX_dec() selects the kernel of every width with NUM_U16_KERNEL,
+ *	NUM_U32_KERNEL and NUM_U64_KERNEL, e.g. in the makefile:
+ *	CDEFS += -DNUM_U32_KERNEL=NUM_KERNEL_MUL
+ *	Both kernels stay available under their own names, num-bench.c
+ *	counts the cycles of both for 0, the slowest value and the maximum
+ *	of every width (Timer1 on the target or in simulavr).
+ *
+ *	The dec-kernels write exactly digits chars with leading zeros and
+ *	no terminator. The value has to be < 10^digits.
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define NUM_KERNEL_SUB		0	// subtract powers of ten
+#define NUM_KERNEL_MUL		1	// multiply by reciprocal
+
+// _sub as long as num-bench.c has not been run on the target
+#ifndef NUM_U16_KERNEL
+	#define NUM_U16_KERNEL	NUM_KERNEL_SUB
+#endif
+#ifndef NUM_U32_KERNEL
+	#define NUM_U32_KERNEL	NUM_KERNEL_SUB
+#endif
+#ifndef NUM_U64_KERNEL
+	#define NUM_U64_KERNEL	NUM_KERNEL_SUB
+#endif
+
+#define NUM_U16_DIGITS		5	// 65535
+#define NUM_U32_DIGITS		10	// 4294967295
+#define NUM_U64_DIGITS		20	// 18446744073709551615
+
+/**
+ *	@brief   Power of ten from the flash table
+ *
+ *  @param k	Exponent 0..9
+ * 	@return  10^k
+*/
+uint32_t num_pow10(uint8_t k);
+
+/**
+ *	@brief   Convert 16 bit by subtraction of powers of ten
+ *
+ *  @param dst		Destination, digits chars, not terminated
+ *  @param value	Value < 10^digits
+ *  @param digits	Number of digits 1..5
+ * 	@return  none
+*/
+void num_u16_dec_sub(char *dst, uint16_t value, uint8_t digits);
+
+/**
+ *	@brief   Convert 16 bit by multiplication with the reciprocal of 10
+ *	@see num_u16_dec_sub
+*/
+void num_u16_dec_mul(char *dst, uint16_t value, uint8_t digits);
+
+/**
+ *	@brief   Convert 32 bit by subtraction of powers of ten
+ *
+ *  @param dst		Destination, digits chars, not terminated
+ *  @param value	Value < 10^digits
+ *  @param digits	Number of digits 1..10
+ * 	@return  none
+*/
+void num_u32_dec_sub(char *dst, uint32_t value, uint8_t digits);
+
+/**
+ *	@brief   Convert 32 bit by multiplication with the reciprocal of 10
+ *	@see num_u32_dec_sub
+*/
+void num_u32_dec_mul(char *dst, uint32_t value, uint8_t digits);
+
+/**
+ *	@brief   Convert 64 bit by subtraction of powers of ten
+ *
+ *  @param dst		Destination, digits chars, not terminated
+ *  @param value	Value < 10^digits
+ *  @param digits	Number of digits 1..20
+ * 	@return  none
+*/
+void num_u64_dec_sub(char *dst, uint64_t value, uint8_t digits);
+
+/**
+ *	@brief   Convert 64 bit by multiplication with the reciprocal of 10
+ *	@see num_u64_dec_sub
+*/
+void num_u64_dec_mul(char *dst, uint64_t value, uint8_t digits);
+
+#if NUM_U16_KERNEL == NUM_KERNEL_MUL
+	#define num_u16_dec		num_u16_dec_mul
+#else
+	#define num_u16_dec		num_u16_dec_sub
+#endif
+#if NUM_U32_KERNEL == NUM_KERNEL_MUL
+	#define num_u32_dec		num_u32_dec_mul
+#else
+	#define num_u32_dec		num_u32_dec_sub
+#endif
+#if NUM_U64_KERNEL == NUM_KERNEL_MUL
+	#define num_u64_dec		num_u64_dec_mul
+#else
+	#define num_u64_dec		num_u64_dec_sub
+#endif
+
+/**
+ *	@brief   Number of decimal digits of a 32 bit value
+ *
+ *  @param value	Value
+ * 	@return  1..10
+*/
+uint8_t num_u32_len(uint32_t value);
+
+/**
+ *	@brief   Convert 32 bit to a string without leading zeros
+ *
+ *  @param dst		Destination, at least 11 chars
+ *  @param value	Value
+ * 	@return  Length of the string
+*/
+uint8_t num_u32_str(char *dst, uint32_t value);
+
+/**
+ *	@brief   Convert signed 32 bit to a string without leading zeros
+ *
+ *  @param dst		Destination, at least 12 chars
+ *  @param value	Value
+ * 	@return  Length of the string
+*/
+uint8_t num_i32_str(char *dst, int32_t value);
+
+/**@}*/
+
+#endif
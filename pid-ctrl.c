@@ -0,0 +1,105 @@
+/*************************************************************************
+Title:		PID controller
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		pid-ctrl.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description:	Fixed-point PID with anti-windup, rate limit, manual mode
+Usage:		see pid-ctrl.h
+*************************************************************************/
+	#include <stdint.h>
+	#include "pid-ctrl.h"
+
+/*************************************************************************
+Function: pid_init()
+Purpose:  Set the parameters, manual mode
+Input:    loop, gains, output range, rate limit
+Returns:  none
+**************************************************************************/
+void pid_init(pid_ctrl_t *c, int16_t kp, int16_t ki, int16_t kd,
+			  int16_t out_min, int16_t out_max, int16_t rate)
+{
+	c->kp = kp;
+	c->ki = ki;
+	c->kd = kd;
+	c->out_min = out_min;
+	c->out_max = out_max;
+	c->rate = rate;
+	c->manual = out_min;
+	c->out = out_min;
+	c->integ = (int32_t)out_min * PID_ONE;
+	c->mode = PID_MANUAL;
+}
+
+/*************************************************************************
+Function: pid_limit()
+Purpose:  Hold the integrator in the output range (anti-windup)
+Input:    loop
+Returns:  none
+**************************************************************************/
+static void pid_limit(pid_ctrl_t *c)
+{
+	if (c->integ > (int32_t)c->out_max * PID_ONE) {
+		c->integ = (int32_t)c->out_max * PID_ONE;
+	}
+	else if (c->integ < (int32_t)c->out_min * PID_ONE) {
+		c->integ = (int32_t)c->out_min * PID_ONE;
+	}
+}
+
+/*************************************************************************
+Function: pid_mode()
+Purpose:  Switch between auto and manual without a bump
+Input:    loop, mode
+Returns:  none
+**************************************************************************/
+void pid_mode(pid_ctrl_t *c, uint8_t mode)
+{
+	if (mode == c->mode) return;
+	if (mode == PID_AUTO) {
+		// the P term of the first step is taken off the integrator
+		c->integ = (int32_t)c->out * PID_ONE
+				 - (int32_t)c->kp * (c->setpoint - c->last_in);
+		pid_limit(c);
+	}
+	else {
+		c->manual = c->out;				// manual goes on from here
+	}
+	c->mode = mode;
+}
+
+/*************************************************************************
+Function: pid_step()
+Purpose:  One step of the loop
+Input:    loop, input
+Returns:  output
+**************************************************************************/
+int16_t pid_step(pid_ctrl_t *c, int16_t in)
+{
+	int32_t acc;
+	int16_t e, d, u;
+
+	e = c->setpoint - in;
+	d = in - c->last_in;
+	c->last_in = in;
+
+	if (c->mode == PID_AUTO) {
+		c->integ += (int32_t)c->ki * e;
+		pid_limit(c);
+		acc = (int32_t)c->kp * e + c->integ - (int32_t)c->kd * d;
+		acc >>= 8;						// / PID_ONE, no 32 bit division
+		if (acc > c->out_max) acc = c->out_max;
+		if (acc < c->out_min) acc = c->out_min;
+		u = acc;
+	}
+	else {
+		u = c->manual;
+	}
+
+	if (c->rate) {
+		if (u > c->out + c->rate) u = c->out + c->rate;
+		else if (u < c->out - c->rate) u = c->out - c->rate;
+	}
+	c->out = u;
+	return u;
+}
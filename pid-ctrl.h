@@ -0,0 +1,104 @@
+/*************************************************************************
+Title:		PID controller
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		pid-ctrl.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description: 	Fixed-point PID with anti-windup, rate limit, manual mode
+Usage:
+*************************************************************************/
+
+#ifndef PID_CTRL_H
+	#define PID_CTRL_H
+
+/**
+ *  @defgroup moe_PID_CTRL PID controller
+ *  @code #include <pid-ctrl.h> @endcode
+ *
+ *  @brief Integer PID for a fixed sample rate
+ *
+ *	pid_step() is called at a fixed rate with the filtered input, the
+ *	gains contain the sample time. Only 16x16 bit multiplications, one
+ *	step takes a few hundred cycles and may run in an ISR.
+ *	- gains in 1/256 output steps (PID_ONE = 1.0) per input step
+ *	- D acts on the input only, a setpoint change gives no kick
+ *	- anti-windup: the integrator is held in the output range
+ *	- rate: the output changes at most by rate per step (0 = off)
+ *	- manual: the output is set by hand; the integrator takes over the
+ *	  output when switched to auto (bumpless)
+ *
+ *	@code
+ *	pid_ctrl_t pump;
+ *	pid_init(&pump, 2*PID_ONE, PID_ONE/8, 0, 0, 255, 4);
+ *	pump.setpoint = 512;
+ *	...
+ *	duty = pid_step(&pump, adc);			// every sample
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define PID_ONE				256		// gain 1.0
+#define PID_AUTO			0
+#define PID_MANUAL			1
+
+/** @brief State and parameters of one loop */
+typedef struct {
+	int16_t kp;						// gains, PID_ONE = 1.0
+	int16_t ki;						// per sample
+	int16_t kd;						// per sample
+	int16_t setpoint;				// in input units
+	int16_t out_min;				// output range
+	int16_t out_max;
+	int16_t rate;					// max output change per step, 0 = off
+	int16_t manual;					// output in PID_MANUAL
+	int16_t out;					// last output
+	int16_t last_in;				// last input (D term)
+	int32_t integ;					// integrator, output * PID_ONE
+	uint8_t mode;					// PID_AUTO, PID_MANUAL
+} pid_ctrl_t;
+
+/**
+ *	@brief   Set the parameters, manual mode with output out_min
+ *
+ *  @param c		Loop
+ *  @param kp		Gains, PID_ONE = 1.0
+ *  @param ki
+ *  @param kd
+ *  @param out_min	Output range
+ *  @param out_max
+ *  @param rate		Max output change per step, 0 = off
+ * 	@return  none
+*/
+void pid_init(pid_ctrl_t *c, int16_t kp, int16_t ki, int16_t kd,
+			  int16_t out_min, int16_t out_max, int16_t rate);
+
+/**
+ *	@brief   Switch between PID_AUTO and PID_MANUAL without a bump
+ *
+ *	Call with interrupts disabled if pid_step() runs in an ISR.
+ *
+ *  @param c		Loop
+ *  @param mode		PID_AUTO, PID_MANUAL
+ * 	@return  none
+*/
+void pid_mode(pid_ctrl_t *c, uint8_t mode);
+
+/**
+ *	@brief   One step of the loop
+ *
+ *  @param c		Loop
+ *  @param in		Input (filtered)
+ * 	@return  Output
+*/
+int16_t pid_step(pid_ctrl_t *c, int16_t in);
+
+/**@}*/
+
+#endif
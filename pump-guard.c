@@ -0,0 +1,108 @@
+/*************************************************************************
+Title:		Pump guard
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		pump-guard.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description:	Dry run and pressure oscillation trip of the pump
+Usage:		see pump-guard.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/interrupt.h>
+	#include "pump-guard.h"
+
+uint16_t guard_p_low;
+
+static volatile uint8_t guard_latch;		// faults
+static uint16_t guard_dry;				// dry run counter
+static uint16_t guard_osc;				// oscillation score
+static uint16_t guard_mean;				// pressure << GUARD_OSC_SHIFT
+static int8_t guard_side;				// -1 below, 1 above the band
+static uint16_t guard_pulses;			// pulse counter of the last sample
+
+/*************************************************************************
+Function: guard_clear()
+Purpose:  Clear the counters
+Input:    pressure
+Returns:  none
+**************************************************************************/
+static void guard_clear(uint16_t press)
+{
+	guard_dry = 0;
+	guard_osc = 0;
+	guard_side = 0;
+	guard_mean = press << GUARD_OSC_SHIFT;
+}
+
+/*************************************************************************
+Function: guard_step()
+Purpose:  One control sample
+Input:    duty, pressure, flow pulse counter
+Returns:  1 if a fault is latched
+**************************************************************************/
+uint8_t guard_step(uint8_t duty, uint16_t press, uint16_t pulses)
+{
+	uint16_t n, mean;
+	int8_t side;
+
+	n = pulses - guard_pulses;				// new pulses, wraps
+	guard_pulses = pulses;
+	if (guard_latch) return 1;
+	if (duty < GUARD_DUTY_ON) {
+		guard_clear(press);
+		return 0;
+	}
+
+	// Dry run: pressure low, flow near zero
+	if (press >= guard_p_low) {
+		guard_dry = 0;
+	}
+	else {
+		guard_dry++;
+		if (n) {							// flow pays back
+			if ((uint32_t)n * GUARD_FLOW_CREDIT >= guard_dry) guard_dry = 0;
+			else guard_dry -= n * GUARD_FLOW_CREDIT;
+		}
+		if (guard_dry >= GUARD_DRY_TRIP) guard_latch |= GUARD_DRY;
+	}
+
+	// Oscillation: crossings of the mean outside the band
+	guard_mean += press - (guard_mean >> GUARD_OSC_SHIFT);
+	mean = guard_mean >> GUARD_OSC_SHIFT;
+	side = 0;
+	if (press > mean + GUARD_OSC_BAND) side = 1;
+	else if (press + GUARD_OSC_BAND < mean) side = -1;
+	if (guard_osc) guard_osc--;
+	if (side && side != guard_side) {
+		if (guard_side) guard_osc += GUARD_OSC_HIT;	// a crossing
+		guard_side = side;
+	}
+	if (guard_osc >= GUARD_OSC_TRIP) guard_latch |= GUARD_OSC;
+
+	return guard_latch != 0;
+}
+
+/*************************************************************************
+Function: guard_fault()
+Purpose:  Latched faults
+Input:    none
+Returns:  GUARD_DRY, GUARD_OSC
+**************************************************************************/
+uint8_t guard_fault(void)
+{
+	return guard_latch;
+}
+
+/*************************************************************************
+Function: guard_ack()
+Purpose:  Acknowledge the faults
+Input:    none
+Returns:  none
+**************************************************************************/
+void guard_ack(void)
+{
+	cli();
+	guard_clear(guard_mean >> GUARD_OSC_SHIFT);
+	guard_latch = 0;
+	sei();
+}
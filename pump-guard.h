@@ -0,0 +1,97 @@
+/*************************************************************************
+Title:		Pump guard
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		pump-guard.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description: 	Dry run and pressure oscillation trip of the pump
+Usage:
+*************************************************************************/
+
+#ifndef PUMP_GUARD_H
+	#define PUMP_GUARD_H
+
+/**
+ *  @defgroup moe_PUMP_GUARD Pump guard
+ *  @code #include <pump-guard.h> @endcode
+ *
+ *  @brief Protection of the pump, evaluated with every control sample
+ *
+ *	guard_step() gets the duty, the pressure and the flow pulse counter
+ *	of every control step. Each check is a counter updated per sample:
+ *	- Dry run: pump on and pressure below guard_p_low counts up by one
+ *	  per sample, every flow pulse counts down by GUARD_FLOW_CREDIT.
+ *	  Without flow the pump trips after GUARD_DRY_TRIP samples, a flow
+ *	  below one pulse per GUARD_FLOW_CREDIT samples trips later.
+ *	- Oscillation (cavitation): the pressure crossing its mean (EMA)
+ *	  by more than GUARD_OSC_BAND adds GUARD_OSC_HIT, every sample
+ *	  takes one. Crossings faster than every GUARD_OSC_HIT samples
+ *	  trip after at most GUARD_OSC_TRIP / (GUARD_OSC_HIT - n) crossings
+ *	  n samples apart.
+ *	A trip is latched, guard_step() returns 1 until guard_ack().
+ *	Pump off clears the counters.
+ *
+ *	@code
+ *	ISR(ADC_vect)							// control step
+ *	{
+ *		duty = pid_step(&pump, press);
+ *		if (guard_step(duty, press, dose_flow)) duty = 0;
+ *	}
+ *	...
+ *	if (guard_fault() & GUARD_DRY) ...		// show, then guard_ack()
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros, in control samples (12.8ms)
+*/
+#ifndef GUARD_DUTY_ON
+	#define GUARD_DUTY_ON	26		// duty 0..255 of a running pump (10%)
+#endif
+#define GUARD_DRY_TRIP		782		// samples without flow (10s)
+#define GUARD_FLOW_CREDIT	782		// samples per flow pulse (10s)
+#define GUARD_OSC_BAND		10		// ADC steps around the mean
+#define GUARD_OSC_SHIFT		5		// mean over 32 samples
+#define GUARD_OSC_HIT		40		// per crossing
+#define GUARD_OSC_TRIP		400
+
+// Faults
+#define GUARD_DRY			0x01	// pump on, pressure low, no flow
+#define GUARD_OSC			0x02	// pressure oscillation
+
+extern uint16_t guard_p_low;		// ADC steps, below: pump runs dry
+
+/**
+ *	@brief   One control sample, call from the control step
+ *
+ *  @param duty		Duty of the pump 0..255
+ *  @param press	Pressure, ADC steps
+ *  @param pulses	Flow pulse counter, free running
+ * 	@return  1 if a fault is latched: pump off
+*/
+uint8_t guard_step(uint8_t duty, uint16_t press, uint16_t pulses);
+
+/**
+ *	@brief   Latched faults
+ *
+ *	@param   none
+ * 	@return  GUARD_DRY, GUARD_OSC or 0
+*/
+uint8_t guard_fault(void);
+
+/**
+ *	@brief   Acknowledge the faults, the counters start again
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void guard_ack(void);
+
+/**@}*/
+
+#endif
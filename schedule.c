@@ -0,0 +1,263 @@
+/*************************************************************************
+Title:		Schedule
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		schedule.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description:	Weekly valve programs in the EEPROM
+Usage:		see schedule.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <string.h>
+	#include <avr/eeprom.h>
+	#include <avr/pgmspace.h>
+	#include "soft-clock.h"
+	#include "calendar.h"
+	#include "schedule.h"
+
+sched_prog_t sched_prog[SCHED_PROGS];
+
+static sched_prog_t ee_sched[SCHED_PROGS] EEMEM;	// erased: all off
+static uint16_t sched_at = SCHED_NEVER;		// planned start
+static uint8_t sched_idx;					// program of the planned start
+static uint8_t sched_skip;					// 1 ... sched_at is a week ahead
+
+static const char sched_day[7] PROGMEM = { 'M', 'T', 'W', 'T', 'F', 'S', 'S' };
+
+/*************************************************************************
+Function: sched_valid()
+Purpose:  Check a program
+Input:    program
+Returns:  1 if valid
+**************************************************************************/
+static uint8_t sched_valid(const sched_prog_t *p)
+{
+	return !(p->days & 0x80) && p->start < SCHED_DAY_MIN
+		&& p->mode <= SCHED_VOLUME && p->valve < SCHED_VALVES;
+}
+
+/*************************************************************************
+Function: sched_init()
+Purpose:  Load the programs from the EEPROM
+Input:    none
+Returns:  none
+**************************************************************************/
+void sched_init(void)
+{
+	uint8_t i;
+
+	eeprom_read_block(sched_prog, ee_sched, sizeof(sched_prog));
+	for (i = 0; i < SCHED_PROGS; i++) {
+		if (!sched_valid(&sched_prog[i])) sched_prog[i].days = 0;
+	}
+	sched_at = SCHED_NEVER;
+}
+
+/*************************************************************************
+Function: sched_minute()
+Purpose:  Minute of the week
+Input:    Unix time
+Returns:  0..SCHED_WEEK_MIN-1
+**************************************************************************/
+uint16_t sched_minute(uint32_t s)
+{
+	return cal_weekday(s) * SCHED_DAY_MIN + (uint16_t)((s % CAL_DAY_SEC) / 60);
+}
+
+/*************************************************************************
+Function: sched_find()
+Purpose:  Plan the first start after now, in the order minute, program;
+          a start at now counts only for the programs from first on
+Input:    minute of the week, first program
+Returns:  none
+**************************************************************************/
+static void sched_find(uint16_t now, uint8_t first)
+{
+	uint8_t i, d;
+	uint16_t m, dist, best;
+
+	best = SCHED_WEEK_MIN + 1;
+	sched_at = SCHED_NEVER;
+	for (i = 0; i < SCHED_PROGS; i++) {
+		m = sched_prog[i].start;
+		for (d = 0; d < 7; d++, m += SCHED_DAY_MIN) {
+			if (!(sched_prog[i].days & (1<<d))) continue;
+			dist = (m >= now) ? m - now : m + SCHED_WEEK_MIN - now;
+			if (dist == 0 && i < first) dist = SCHED_WEEK_MIN;	// next week
+			if (dist < best) {					// equal: lower index first
+				best = dist;
+				sched_at = m;
+				sched_idx = i;
+			}
+		}
+	}
+	sched_skip = (best == SCHED_WEEK_MIN);
+}
+
+/*************************************************************************
+Function: sched_plan()
+Purpose:  Plan the next start after now
+Input:    minute of the week
+Returns:  none
+**************************************************************************/
+void sched_plan(uint16_t now)
+{
+	sched_find(now, SCHED_PROGS);
+}
+
+/*************************************************************************
+Function: sched_due()
+Purpose:  Program starting now
+Input:    minute of the week
+Returns:  index or SCHED_NONE
+**************************************************************************/
+uint8_t sched_due(uint16_t now)
+{
+	uint8_t i;
+
+	if (sched_at != now) {
+		sched_skip = 0;							// from now on: next week
+		return SCHED_NONE;
+	}
+	if (sched_skip) return SCHED_NONE;			// started a week ago
+	i = sched_idx;
+	sched_find(now, i + 1);						// same minute, next programs
+	return i;
+}
+
+/*************************************************************************
+Function: sched_next()
+Purpose:  Planned start
+Input:    none
+Returns:  minute of the week or SCHED_NEVER
+**************************************************************************/
+uint16_t sched_next(void)
+{
+	return sched_at;
+}
+
+/*************************************************************************
+Function: sched_set()
+Purpose:  Change a program, EEPROM only if changed
+Input:    index, program
+Returns:  none
+**************************************************************************/
+void sched_set(uint8_t i, const sched_prog_t *p)
+{
+	if (i >= SCHED_PROGS) return;
+	if (memcmp(&sched_prog[i], p, sizeof(sched_prog_t)) == 0) return;
+	sched_prog[i] = *p;
+	eeprom_write_block(p, &ee_sched[i], sizeof(sched_prog_t));
+}
+
+/*************************************************************************
+Function: sched_format()
+Purpose:  Text of a program
+Input:    destination, index
+Returns:  destination
+**************************************************************************/
+static char *sched_num(char *s, uint16_t v)
+{
+	char buf[5];
+	uint8_t n = 0;
+
+	do {
+		buf[n++] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+	while (n) *s++ = buf[--n];
+	return s;
+}
+
+char *sched_format(char *dst, uint8_t i)
+{
+	const sched_prog_t *p = &sched_prog[i];
+	char *s = dst;
+	uint8_t d;
+
+	*s++ = 'P';
+	s = sched_num(s, i + 1);
+	*s++ = ' ';
+	if (!p->days) {
+		*s++ = '-';
+	}
+	else {
+		for (d = 0; d < 7; d++) {
+			*s++ = (p->days & (1<<d)) ? pgm_read_byte(&sched_day[d]) : '-';
+		}
+		*s++ = ' ';
+		*s++ = '0' + p->start / 600;
+		*s++ = '0' + p->start / 60 % 10;
+		*s++ = ':';
+		*s++ = '0' + p->start % 60 / 10;
+		*s++ = '0' + p->start % 10;
+		*s++ = ' ';
+		*s++ = (p->mode == SCHED_VOLUME) ? 'L' : 'T';
+		s = sched_num(s, p->amount);
+		*s++ = ' ';
+		*s++ = 'V';
+		s = sched_num(s, p->valve + 1);
+	}
+	*s = '\0';
+	return dst;
+}
+
+/*************************************************************************
+Function: sched_parse()
+Purpose:  Show, change or clear a program from its text
+Input:    text
+Returns:  index or SCHED_NONE
+**************************************************************************/
+static const char *sched_get(const char *s, uint16_t *v)
+{
+	uint32_t n = 0;
+
+	if (*s < '0' || *s > '9') return NULL;
+	while (*s >= '0' && *s <= '9') {
+		n = n * 10 + (*s++ - '0');
+		if (n > 0xFFFF) return NULL;
+	}
+	*v = n;
+	return s;
+}
+
+uint8_t sched_parse(const char *s)
+{
+	sched_prog_t p;
+	uint16_t i, h, m, v;
+	uint8_t d;
+
+	if (*s++ != 'P' || !(s = sched_get(s, &i)) || i < 1 || i > SCHED_PROGS) {
+		return SCHED_NONE;
+	}
+	i--;
+	if (*s == '\0') return i;					// show only
+	if (*s++ != ' ') return SCHED_NONE;
+	memset(&p, 0, sizeof(p));
+	if (s[0] == '-' && s[1] == '\0') {			// off
+		sched_set(i, &p);
+		return i;
+	}
+	for (d = 0; d < 7; d++, s++) {
+		if (*s == '\0' || *s == ' ') return SCHED_NONE;
+		if (*s != '-') p.days |= 1<<d;
+	}
+	if (*s++ != ' ' || !(s = sched_get(s, &h)) || *s++ != ':'
+		|| !(s = sched_get(s, &m)) || h > 23 || m > 59 || *s++ != ' ') {
+		return SCHED_NONE;
+	}
+	p.start = h * 60 + m;
+	if (*s == 'L') p.mode = SCHED_VOLUME;
+	else if (*s != 'T') return SCHED_NONE;
+	if (!(s = sched_get(s + 1, &p.amount)) || !p.amount) return SCHED_NONE;
+	p.valve = 0;
+	if (*s == ' ') {							// valve, default 1
+		if (*++s != 'V' || !(s = sched_get(s + 1, &v)) || v < 1 || v > SCHED_VALVES) {
+			return SCHED_NONE;
+		}
+		p.valve = v - 1;
+	}
+	if (*s != '\0') return SCHED_NONE;
+	sched_set(i, &p);
+	return i;
+}
@@ -0,0 +1,158 @@
+/*************************************************************************
+Title:		Schedule
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		schedule.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR
+Description: 	Weekly valve programs in the EEPROM
+Usage:
+*************************************************************************/
+
+#ifndef SCHEDULE_H
+	#define SCHEDULE_H
+
+/**
+ *  @defgroup moe_SCHEDULE Schedule
+ *  @code #include <schedule.h> @endcode
+ *
+ *  @brief Weekly programs with the next start computed in advance
+ *
+ *	A program opens a valve on the selected days of the week at a start
+ *	time, for a number of minutes or for a volume. The programs are
+ *	kept in the EEPROM with a copy in SRAM.
+ *	Times are minutes of the week (0 = Monday 00:00). sched_plan()
+ *	looks for the next start of all programs, sched_due() has to
+ *	compare only this one start, every minute. After a start the next
+ *	one is planned, after a change or after the clock was set
+ *	sched_plan() has to be called.
+ *
+ *	Text form of a program, for the UART:
+ *	"P1 MTWTF-- 06:30 T15 V1"	days Monday..Sunday ('-' = off), start,
+ *								T minutes or L liters, valve 1..
+ *	"P1 -"						program 1 off
+ *
+ *	@code
+ *	sched_init();
+ *	sched_plan(sched_minute(clk_now()));		// starts after this minute
+ *	...
+ *	if (k & CLK_MIN) {						// every minute
+ *		now = sched_minute(clk_now());
+ *		while ((i = sched_due(now)) != SCHED_NONE) start(&sched_prog[i]);
+ *	}
+ *	...
+ *	if (sched_parse("P2 -----SS 07:00 L200 V1") != SCHED_NONE) sched_plan(now);
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define SCHED_PROGS			8
+#ifndef SCHED_VALVES
+	#define SCHED_VALVES	1		// valve 0: dosing valve
+#endif
+#define SCHED_DAY_MIN		1440U
+#define SCHED_WEEK_MIN		(7 * SCHED_DAY_MIN)
+#define SCHED_NONE			0xFF	// no program
+#define SCHED_NEVER			0xFFFF	// no start planned
+#define SCHED_LINE_LEN		26		// text of a program
+
+// Modes
+#define SCHED_TIME			0		// amount in minutes
+#define SCHED_VOLUME		1		// amount in liters (flow pulses)
+
+/** @brief One program */
+typedef struct {
+	uint8_t days;					// bit 0 Monday .. bit 6 Sunday, 0 = off
+	uint16_t start;					// minute of the day
+	uint8_t mode;					// SCHED_TIME, SCHED_VOLUME
+	uint8_t valve;					// 0..SCHED_VALVES-1
+	uint16_t amount;				// minutes or liters
+} sched_prog_t;
+
+extern sched_prog_t sched_prog[SCHED_PROGS];
+
+/**
+ *	@brief   Load the programs from the EEPROM, invalid ones are off
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void sched_init(void);
+
+/**
+ *	@brief   Minute of the week of a time
+ *
+ *  @param s	Seconds since 1970-01-01, e.g. clk_now()
+ * 	@return  0 (Monday 00:00) .. SCHED_WEEK_MIN-1
+*/
+uint16_t sched_minute(uint32_t s);
+
+/**
+ *	@brief   Plan the next start after now
+ *
+ *	A program starting in this minute starts next week.
+ *
+ *  @param now	Minute of the week
+ * 	@return  none
+*/
+void sched_plan(uint16_t now);
+
+/**
+ *	@brief   Program starting now, call every minute
+ *
+ *	Only the planned start is compared. Call again until SCHED_NONE,
+ *	several programs may start in the same minute.
+ *
+ *  @param now	Minute of the week
+ * 	@return  Index of the program or SCHED_NONE
+*/
+uint8_t sched_due(uint16_t now);
+
+/**
+ *	@brief   Planned start
+ *
+ *	@param   none
+ * 	@return  Minute of the week or SCHED_NEVER
+*/
+uint16_t sched_next(void);
+
+/**
+ *	@brief   Change a program, written to the EEPROM if changed
+ *
+ *	Call sched_plan() afterwards.
+ *
+ *  @param i	Index 0..SCHED_PROGS-1
+ *  @param p	Program
+ * 	@return  none
+*/
+void sched_set(uint8_t i, const sched_prog_t *p);
+
+/**
+ *	@brief   Text of a program, e.g. "P1 MTWTF-- 06:30 T15 V1"
+ *
+ *  @param dst	Destination, at least SCHED_LINE_LEN+1 chars
+ *  @param i	Index 0..SCHED_PROGS-1
+ * 	@return  dst
+*/
+char *sched_format(char *dst, uint8_t i);
+
+/**
+ *	@brief   Show, change or clear a program from its text
+ *
+ *	"P1" only selects the program, "P1 -" clears it, a complete text
+ *	changes it (sched_set()).
+ *
+ *  @param s	Text
+ * 	@return  Index of the program or SCHED_NONE on a syntax error
+*/
+uint8_t sched_parse(const char *s);
+
+/**@}*/
+
+#endif
@@ -0,0 +1,204 @@
+/*************************************************************************
+Title:		Software clock
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		soft-clock.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, 100ms tick, optional RTC (ds3231)
+Description:	Time and date from the system tick with ppm trimming
+Usage:		see soft-clock.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <avr/pgmspace.h>
+	#include "soft-clock.h"
+	#include "calendar.h"
+
+#define CLK_FRAC_ONE		1000000L	// ppm ticks of one tick
+
+clk_time_t clk = { 0, 0, 0, 1, 1, 0 };
+
+static uint32_t clk_unix = CAL_UNIX_2000;	// Unix time of clk
+static uint8_t clk_tenth;				// ticks of the current second
+static int16_t clk_ppm;
+static int32_t clk_frac;				// accumulated trim, ppm ticks
+static uint8_t clk_synced;				// 1 ... set by a RTC before
+static int32_t clk_drift;				// sum of the sync steps, 100ms
+static uint32_t clk_learn;				// s since the drift is summed up
+
+static const uint8_t clk_mdays[12] PROGMEM = {
+	31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+/*************************************************************************
+Function: clk_trim()
+Purpose:  Set the trim
+Input:    ppm
+Returns:  none
+**************************************************************************/
+void clk_trim(int16_t ppm)
+{
+	if (ppm > CLK_TRIM_MAX) ppm = CLK_TRIM_MAX;
+	if (ppm < -CLK_TRIM_MAX) ppm = -CLK_TRIM_MAX;
+	clk_ppm = ppm;
+}
+
+/*************************************************************************
+Function: clk_trim_get()
+Purpose:  Current trim
+Input:    none
+Returns:  ppm
+**************************************************************************/
+int16_t clk_trim_get(void)
+{
+	return clk_ppm;
+}
+
+/*************************************************************************
+Function: clk_now()
+Purpose:  Time stamp
+Input:    none
+Returns:  Unix time of the clock
+**************************************************************************/
+uint32_t clk_now(void)
+{
+	return clk_unix;
+}
+
+/*************************************************************************
+Function: clk_next_day()
+Purpose:  Advance the date by one day
+Input:    none
+Returns:  none
+**************************************************************************/
+static void clk_next_day(void)
+{
+	uint8_t n;
+
+	n = pgm_read_byte(&clk_mdays[(clk.month - 1) % 12]);
+	if (clk.month == 2 && (clk.year & 3) == 0) n++;	// 2000..2099
+	if (++clk.day > n) {
+		clk.day = 1;
+		if (++clk.month > 12) {
+			clk.month = 1;
+			if (++clk.year > 99) clk.year = 0;
+		}
+	}
+}
+
+/*************************************************************************
+Function: clk_second()
+Purpose:  Advance the clock by one second
+Input:    none
+Returns:  units which changed
+**************************************************************************/
+static uint8_t clk_second(void)
+{
+	clk_learn++;
+	clk_unix++;
+	if (++clk.sec < 60) return CLK_SEC;
+	clk.sec = 0;
+	if (++clk.min < 60) return CLK_SEC | CLK_MIN;
+	clk.min = 0;
+	if (++clk.hour < 24) return CLK_SEC | CLK_MIN | CLK_HOUR;
+	clk.hour = 0;
+	clk_next_day();
+	return CLK_SEC | CLK_MIN | CLK_HOUR | CLK_DAY;
+}
+
+/*************************************************************************
+Function: clk_tick()
+Purpose:  Advance the clock by 100ms, add or drop a tick by the trim
+Input:    none
+Returns:  units which changed
+**************************************************************************/
+uint8_t clk_tick(void)
+{
+	uint8_t n, f;
+
+	n = 1;
+	clk_frac += clk_ppm;
+	if (clk_frac >= CLK_FRAC_ONE) {
+		clk_frac -= CLK_FRAC_ONE;
+		n = 2;							// crystal slow: one more tick
+	}
+	else if (clk_frac <= -CLK_FRAC_ONE) {
+		clk_frac += CLK_FRAC_ONE;
+		n = 0;							// crystal fast: drop the tick
+	}
+	f = 0;
+	while (n--) {
+		if (++clk_tenth >= CLK_TICKS) {
+			clk_tenth = 0;
+			f |= clk_second();
+		}
+	}
+	return f;
+}
+
+/*************************************************************************
+Function: clk_date_cmp()
+Purpose:  Compare the date of a time with the clock
+Input:    time
+Returns:  <0 before, 0 same day, >0 after the date of the clock
+**************************************************************************/
+static int8_t clk_date_cmp(const clk_time_t *t)
+{
+	if (t->year != clk.year) return t->year < clk.year ? -1 : 1;
+	if (t->month != clk.month) return t->month < clk.month ? -1 : 1;
+	if (t->day != clk.day) return t->day < clk.day ? -1 : 1;
+	return 0;
+}
+
+/*************************************************************************
+Function: clk_set()
+Purpose:  Set the clock by hand, the drift is learned again
+Input:    time
+Returns:  units which changed
+**************************************************************************/
+uint8_t clk_set(const clk_time_t *t)
+{
+	clk_synced = 0;						// the step is no drift
+	return clk_sync(t);
+}
+
+/*************************************************************************
+Function: clk_sync()
+Purpose:  Set the clock from a RTC, correct the trim by the drift
+Input:    time of the RTC
+Returns:  units which changed
+**************************************************************************/
+uint8_t clk_sync(const clk_time_t *t)
+{
+	int32_t step;
+	int8_t cmp;
+
+	cmp = clk_date_cmp(t);
+	step = ((int32_t)t->hour * 60 + t->min) * 60 + t->sec
+		 - (((int32_t)clk.hour * 60 + clk.min) * 60 + clk.sec);
+	if (cmp > 0) step += 86400L;		// sync just after midnight
+	if (cmp < 0) step -= 86400L;
+	step = step * CLK_TICKS - clk_tenth;	// the tenths of the clock count too,
+										// so the read errors of the RTC cancel
+
+	if (clk_synced && step > -CLK_LEARN_STEP*CLK_TICKS && step < CLK_LEARN_STEP*CLK_TICKS) {
+		clk_drift += step;				// RTC ahead: crystal slow
+		if (clk_drift > 20000 || clk_drift < -20000) {
+			clk_drift = 0;				// no drift of the crystal, x1e5
+			clk_learn = 0;				// has to fit in 32 bit
+		}
+		else if (clk_learn >= CLK_LEARN_SEC) {
+			clk_trim(clk_ppm + (int16_t)(clk_drift * (CLK_FRAC_ONE / CLK_TICKS) / (int32_t)clk_learn));
+			clk_drift = 0;
+			clk_learn = 0;
+		}
+	}
+	else {
+		clk_drift = 0;					// seed or set by hand
+		clk_learn = 0;
+	}
+	clk_synced = 1;
+
+	clk = *t;
+	clk_unix = cal_to_unix(t);
+	clk_tenth = 0;						// clk_frac is kept, else the trim is lost
+	return CLK_SEC | CLK_MIN | CLK_HOUR | (cmp > 0 ? CLK_DAY : 0);
+}
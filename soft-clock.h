@@ -0,0 +1,121 @@
+/*************************************************************************
+Title:		Software clock
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		soft-clock.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	every AVR, 100ms tick, optional RTC (ds3231)
+Description: 	Time and date from the system tick with ppm trimming
+Usage:
+*************************************************************************/
+
+#ifndef SOFT_CLOCK_H
+	#define SOFT_CLOCK_H
+
+/**
+ *  @defgroup moe_SOFT_CLOCK Software clock
+ *  @code #include <soft-clock.h> @endcode
+ *
+ *  @brief Time of day and date, trimmed and disciplined by a RTC
+ *
+ *	clk_tick() is called every 100ms. The crystal tolerance is trimmed in
+ *	ppm: the trim is added to an accumulator every tick, one full tick
+ *	of accumulated error (1e6 ppm ticks) adds or drops one tick.
+ *	clk_sync() sets the clock from a RTC (seed at boot, then e.g. every
+ *	hour at half past). The steps of the syncs are summed up, after
+ *	CLK_LEARN_SEC the trim is corrected by the measured drift.
+ *	A sync close to midnight can step the clock back into the day
+ *	before, then clk_tick() reports CLK_DAY a second time.
+ *	The date covers 2000..2099.
+ *
+ *	@code
+ *	clk_trim(ppm);							// from the EEPROM
+ *	if (ds3231_read(&t) == I2C_OK) clk_sync(&t);
+ *	...
+ *	f = clk_tick();							// every 100ms
+ *	if (f & CLK_DAY) ...					// midnight
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define CLK_TICKS			10		// clk_tick() per second
+#define CLK_TRIM_MAX		500		// ppm
+#define CLK_LEARN_SEC		86400UL	// drift measured over one day
+#define CLK_LEARN_STEP		60		// s, a larger step is no drift
+
+// Units which changed (clk_tick(), clk_sync())
+#define CLK_SEC				0x01
+#define CLK_MIN				0x02
+#define CLK_HOUR			0x04
+#define CLK_DAY				0x08	// a new day, midnight
+
+/** @brief Time and date */
+typedef struct {
+	uint8_t sec;					// 0..59
+	uint8_t min;					// 0..59
+	uint8_t hour;					// 0..23
+	uint8_t day;					// 1..31
+	uint8_t month;					// 1..12
+	uint8_t year;					// 0..99 = 2000..2099
+} clk_time_t;
+
+extern clk_time_t clk;				// current time, read in the main loop
+
+/**
+ *	@brief   Set the trim
+ *
+ *  @param ppm	Crystal too slow: positive, -CLK_TRIM_MAX..CLK_TRIM_MAX
+ * 	@return  none
+*/
+void clk_trim(int16_t ppm);
+
+/**
+ *	@brief   Current trim, changed by clk_sync()
+ *
+ *	@param   none
+ * 	@return  ppm
+*/
+int16_t clk_trim_get(void);
+
+/**
+ *	@brief   Time stamp of the clock, e.g. for records
+ *
+ *	@param   none
+ * 	@return  Seconds since 1970-01-01 (calendar.h)
+*/
+uint32_t clk_now(void);
+
+/**
+ *	@brief   Advance the clock by 100ms (trimmed)
+ *
+ *	@param   none
+ * 	@return  CLK_SEC | CLK_MIN | ... of the units which changed
+*/
+uint8_t clk_tick(void);
+
+/**
+ *	@brief   Set the clock from a RTC and learn the drift
+ *
+ *  @param t	Time of the RTC
+ * 	@return  CLK_SEC | CLK_MIN | CLK_HOUR, CLK_DAY if the date went ahead
+*/
+uint8_t clk_sync(const clk_time_t *t);
+
+/**
+ *	@brief   Set the clock by hand (e.g. from the UART), the drift
+ *			 learning starts again
+ *
+ *  @param t	Time
+ * 	@return  as clk_sync()
+*/
+uint8_t clk_set(const clk_time_t *t);
+
+/**@}*/
+
+#endif
@@ -0,0 +1,134 @@
+/*************************************************************************
+Title:		Supervisor
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		supervisor.c, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	ATmega328, watchdog
+Description:	Watchdog fed only with heartbeats of all tasks
+Usage:		see supervisor.h
+*************************************************************************/
+	#include <stdint.h>
+	#include <string.h>
+	#include <avr/io.h>
+	#include <avr/interrupt.h>
+	#include <avr/eeprom.h>
+	#include <avr/wdt.h>
+	#include "supervisor.h"
+
+#define SUP_NOINIT		__attribute__((section(".noinit")))
+
+sup_rec_t sup_rec;
+
+static sup_rec_t ee_sup_rec EEMEM = { 0, 0, 0 };
+static uint8_t sup_run;						// tasks of sup_init()
+static uint8_t sup_tasks SUP_NOINIT;		// supervised now
+static volatile uint8_t sup_alive SUP_NOINIT;	// survives a reset
+static uint8_t sup_mcusr SUP_NOINIT;
+
+/*************************************************************************
+Function: sup_early()
+Purpose:  Save and clear MCUSR, the watchdog is off before main()
+          (after a watchdog reset it would run with 16ms)
+Input:    none
+Returns:  none
+**************************************************************************/
+void sup_early(void) __attribute__((naked, used, section(".init3")));
+void sup_early(void)
+{
+	sup_mcusr = MCUSR;
+	MCUSR = 0;
+	wdt_disable();
+}
+
+/*************************************************************************
+Function: sup_init()
+Purpose:  Record the reset cause, enable the watchdog
+Input:    bits of the tasks
+Returns:  none
+**************************************************************************/
+void sup_init(uint8_t tasks)
+{
+	sup_rec_t old;
+
+	eeprom_read_block(&sup_rec, &ee_sup_rec, sizeof(sup_rec));
+	if (sup_rec.count == 0xFF) {				// erased
+		sup_rec.tasks = 0;
+		sup_rec.count = 0;
+	}
+	memcpy(&old, &sup_rec, sizeof(old));
+	sup_rec.cause = sup_mcusr;
+	if (sup_mcusr & (1<<WDRF)) {
+		sup_rec.tasks = sup_tasks & ~sup_alive;
+		if (sup_rec.count < 0xFE) sup_rec.count++;
+	}
+	if (memcmp(&old, &sup_rec, sizeof(old)) != 0) {
+		eeprom_write_block(&sup_rec, &ee_sup_rec, sizeof(sup_rec));
+	}
+
+	sup_run = tasks;
+	sup_tasks = SUP_BOOT;
+	sup_alive = 0;
+	wdt_enable(SUP_TIMEOUT);
+}
+
+/*************************************************************************
+Function: sup_boot()
+Purpose:  Heartbeat of the start up
+Input:    none
+Returns:  none
+**************************************************************************/
+void sup_boot(void)
+{
+	sup_beat(SUP_BOOT);
+	sup_check();
+}
+
+/*************************************************************************
+Function: sup_start()
+Purpose:  Supervise the tasks from now on
+Input:    none
+Returns:  none
+**************************************************************************/
+void sup_start(void)
+{
+	uint8_t sreg = SREG;
+
+	cli();
+	sup_tasks = sup_run;
+	sup_alive = 0;
+	wdt_reset();
+	SREG = sreg;
+}
+
+/*************************************************************************
+Function: sup_beat()
+Purpose:  Heartbeat of a task
+Input:    bit of the task
+Returns:  none
+**************************************************************************/
+void sup_beat(uint8_t task)
+{
+	uint8_t sreg = SREG;						// also called from ISRs
+
+	cli();
+	sup_alive |= task;
+	SREG = sreg;
+}
+
+/*************************************************************************
+Function: sup_check()
+Purpose:  Reset the watchdog if all tasks have beaten
+Input:    none
+Returns:  none
+**************************************************************************/
+void sup_check(void)
+{
+	uint8_t sreg;
+
+	if ((sup_alive & sup_tasks) != sup_tasks) return;
+	sreg = SREG;
+	cli();
+	sup_alive = 0;
+	wdt_reset();
+	SREG = sreg;
+}
@@ -0,0 +1,114 @@
+/*************************************************************************
+Title:		Supervisor
+Author:		Christoph Moser <moserchristoph@gmx.at>
+File:		supervisor.h, v1.0, 2026/10/19
+Software:	WinAVR-20100110 ; AVR-GCC 4.3.3 ; avr-libc 1.6.7
+Hardware: 	ATmega328, watchdog
+Description: 	Watchdog fed only with heartbeats of all tasks
+Usage:
+*************************************************************************/
+
+#ifndef SUPERVISOR_H
+	#define SUPERVISOR_H
+
+/**
+ *  @defgroup moe_SUPERVISOR Supervisor
+ *  @code #include <supervisor.h> @endcode
+ *
+ *  @brief Watchdog with per-task heartbeats and a post-mortem record
+ *
+ *	Every task sets its bit with sup_beat(). sup_check() resets the
+ *	watchdog only when all registered tasks have beaten since the last
+ *	reset of the watchdog, so one stuck task resets the controller
+ *	after SUP_TIMEOUT.
+ *	The heartbeats are kept in .noinit RAM, after a watchdog reset the
+ *	tasks without heartbeat are known. Give the main loop tasks bits
+ *	in the order of the loop: the lowest missing bit is the task which
+ *	hangs. The reset cause (MCUSR, saved in .init3) and the tasks of
+ *	the last watchdog reset are written to the EEPROM (sup_rec).
+ *	The watchdog runs from sup_init() on. During the start up only the
+ *	heartbeat SUP_BOOT is required, sup_start() switches to the tasks.
+ *
+ *	@code
+ *	sup_init(TASK_A | TASK_B);				// first thing in main()
+ *	...
+ *	sup_boot();								// between slow start up steps
+ *	...
+ *	sup_start();							// main loop from here
+ *	while (1) {
+ *		...
+ *		sup_beat(TASK_A);					// also from an ISR
+ *		...
+ *		sup_check();
+ *	}
+ *	@endcode
+ *
+ *  @author Christoph Moser moserch@gmx.at
+ *  @version 1.0
+ */
+
+ /**@{*/
+
+/*
+** constants and macros
+*/
+#define SUP_TIMEOUT			WDTO_2S
+#define SUP_BOOT			0x80	// start up, not a task bit
+
+/** @brief Post-mortem record, in the EEPROM */
+typedef struct {
+	uint8_t cause;					// MCUSR of the last start
+	uint8_t tasks;					// without heartbeat at the last WDT reset,
+									// SUP_BOOT: during the start up
+	uint8_t count;					// watchdog resets, up to 254
+} sup_rec_t;
+
+extern sup_rec_t sup_rec;
+
+/**
+ *	@brief   Record the reset cause and enable the watchdog
+ *
+ *	Until sup_start() only the start up is supervised (sup_boot()).
+ *
+ *  @param tasks	Bits of the supervised tasks, not SUP_BOOT
+ * 	@return  none
+*/
+void sup_init(uint8_t tasks);
+
+/**
+ *	@brief   Heartbeat of the start up, resets the watchdog
+ *
+ *	Call between the slow steps, each shorter than SUP_TIMEOUT.
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void sup_boot(void);
+
+/**
+ *	@brief   End of the start up, the tasks are supervised from now on
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void sup_start(void);
+
+/**
+ *	@brief   Heartbeat of a task, from the main loop or an ISR
+ *
+ *  @param task		Bit of the task
+ * 	@return  none
+*/
+void sup_beat(uint8_t task);
+
+/**
+ *	@brief   Reset the watchdog if all tasks have beaten
+ *
+ *	@param   none
+ * 	@return  none
+*/
+void sup_check(void);
+
+/**@}*/
+
+#endif
@@ -8,81 +8,237 @@
 **************************************************************************/
 #include <inttypes.h>
 #include <compat/twi.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
 #include "i2cmaster.h"
 
-/* I2C clock in Hz */
-//#define SCL_CLOCK  100000L // 100kHz
-#define SCL_CLOCK  100000L // 10kHz
+/* I2C clock in Hz, default of all transfers */
+#ifndef SCL_CLOCK
+#define SCL_CLOCK  100000L // 100kHz
+#endif
+
+/* SCL = F_CPU/(16+2*TWBR*4^TWPS): smallest prescaler with TWBR <= 255 */
+#define TWBR_PS(ps)  ((F_CPU/SCL_CLOCK - 16) / (2 * (ps)))
+#if F_CPU/SCL_CLOCK < 16 + 2*I2C_SCL_TWBR_MIN
+#error "SCL_CLOCK too high for F_CPU"
+#elif TWBR_PS(1) <= 255
+#define I2C_TWPS   0
+#define I2C_TWBR   TWBR_PS(1)
+#elif TWBR_PS(4) <= 255
+#define I2C_TWPS   1
+#define I2C_TWBR   TWBR_PS(4)
+#elif TWBR_PS(16) <= 255
+#define I2C_TWPS   2
+#define I2C_TWBR   TWBR_PS(16)
+#elif TWBR_PS(64) <= 255
+#define I2C_TWPS   3
+#define I2C_TWBR   TWBR_PS(64)
+#else
+#error "SCL_CLOCK too low for F_CPU"
+#endif
+
+/* Pins for the bus clear */
+#define I2C_PORT   PORTC
+#define I2C_DDR    DDRC
+#define I2C_PIN    PINC
+#define I2C_SDA_PIN PC4
+#define I2C_SCL_PIN PC5
+
+/* TWCR of the interrupt driven transactions */
+#define TWCR_IRQ   ((1<<TWINT) | (1<<TWEN) | (1<<TWIE))
+
+/* Transaction queue, ring of descriptors */
+static i2c_xfer_t * volatile i2c_q[I2C_QUEUE_SIZE];
+static volatile uint8_t i2c_q_head;     // next free entry
+static volatile uint8_t i2c_q_tail;     // running transaction
+static volatile uint8_t i2c_q_run;      // 1 .. ISR owns the bus
+static volatile uint8_t i2c_q_owner;    // 1 .. blocking API owns the bus
+static uint8_t i2c_q_idx;               // byte index of the running phase
+static uint8_t i2c_q_read;              // 1 .. read phase
+static uint8_t i2c_q_try;               // address NACKs of the transaction
+static volatile uint8_t i2c_q_wait;     // 1 .. restart after a NACK pending
+static volatile uint8_t i2c_q_clear;    // 1 .. bus clear pending, queue held
+static volatile uint8_t i2c_q_age;      // i2c_tick() calls without progress
+static uint16_t i2c_q_poll;             // us without progress in i2c_poll()
+
+/* Error counters per device */
+typedef struct {
+    uint8_t addr;                       // 0 .. free entry
+    uint8_t fail;                       // failed accesses in a row
+    uint16_t errors;                    // failed accesses since start
+} i2c_dev_t;
+static i2c_dev_t i2c_dev[I2C_DEV_MAX];
+static uint8_t i2c_cur;                 // device of the blocking API
+static uint8_t i2c_clk;                 // TWBR of the blocking API, 0 .. default
+
+volatile uint16_t i2c_recoveries;
+
+static void i2c_kick(void);
+static void i2c_claim(void);
+static void i2c_set_scl(uint8_t twbr);
+static void i2c_dev_note(uint8_t address, uint8_t status);
 
 /*************************************************************************
  Initialization of the I2C bus interface. Need to be called only once
 *************************************************************************/
 void i2c_init(void)
 {
-  /* initialize TWI clock: 100 kHz clock, TWPS = 0 => prescaler = 1 */
-  
-  
-  TWSR = 1;                         /* no prescaler */
-  TWBR = ((F_CPU/SCL_CLOCK)-16)/8;  /* must be > 10 for stable operation */
-  /* SCL = F_CPU/(16+2*(TWBR)*4^(TWPS))
-	TWBR = (F_CPU/SCL-16)/(2*TWBR*4^TWPS)
-	*/
+  /* initialize TWI clock: SCL_CLOCK, TWPS and TWBR computed at compile time */
+  i2c_set_scl(0);
 
 }/* i2c_init */
 
 
+/*************************************************************************
+ Set the bit rate: TWBR with prescaler 1 or 0 for the default SCL_CLOCK
+*************************************************************************/
+static void i2c_set_scl(uint8_t twbr)
+{
+  if (twbr)
+  {
+    TWSR = 0;                       /* prescaler 1 */
+    TWBR = twbr;
+  }
+  else
+  {
+    TWSR = I2C_TWPS;
+    TWBR = I2C_TWBR;
+  }
+
+}/* i2c_set_scl */
+
+
+/*************************************************************************
+ Clock of the following blocking transfers (from the next i2c_start)
+
+ Input:   I2C_SCL(hz), 0 = SCL_CLOCK
+*************************************************************************/
+void i2c_clock(unsigned char twbr)
+{
+  i2c_clk = twbr;
+
+}/* i2c_clock */
+
+
+/*************************************************************************
+ Wait for TWINT, recover the bus after I2C_TIMEOUT_US
+ Return:  0 ok, 1 timeout
+*************************************************************************/
+static uint8_t i2c_wait_int(void)
+{
+    uint16_t n = I2C_TIMEOUT_US;
+
+    while(!(TWCR & (1<<TWINT)))
+    {
+        if (--n == 0)
+        {
+            i2c_dev_note(i2c_cur, I2C_TIMEOUT);
+            i2c_recover();
+            return 1;
+        }
+        _delay_us(1);
+    }
+    return 0;
+
+}/* i2c_wait_int */
+
+
+/*************************************************************************
+ Wait until the STOP condition is executed
+ Input:   max. time in us
+ Return:  0 ok, 1 timeout
+*************************************************************************/
+static uint8_t i2c_stop_done(uint16_t n)
+{
+    while(TWCR & (1<<TWSTO))
+    {
+        if (--n == 0) return 1;
+        _delay_us(1);
+    }
+    return 0;
+
+}/* i2c_stop_done */
+
+
+/*************************************************************************
+ Wait until the STOP condition is executed, recover after I2C_TIMEOUT_US
+*************************************************************************/
+static void i2c_wait_stop(void)
+{
+    if (i2c_stop_done(I2C_TIMEOUT_US)) i2c_recover();
+
+}/* i2c_wait_stop */
+
+
 /*************************************************************************	
   Issues a start condition and sends address and transfer direction.
+  A STOP is sent if the device does not answer.
   return 0 = device accessible, 1= failed to access device
 *************************************************************************/
 unsigned char i2c_start(unsigned char address)
 {
     uint8_t   twst;
 
+	// wait for the queued transactions
+	i2c_claim();
+	i2c_cur = address;
+
 	// send START condition
 	TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN);
 
 	// wait until transmission completed
-	while(!(TWCR & (1<<TWINT)));
+	if (i2c_wait_int()) goto fail;
 
 	// check value of TWI Status Register. Mask prescaler bits.
 	twst = TW_STATUS & 0xF8;
-	if ( (twst != TW_START) && (twst != TW_REP_START)) return 1;
+	if ( (twst != TW_START) && (twst != TW_REP_START)) goto error;
 
 	// send device address
 	TWDR = address;
 	TWCR = (1<<TWINT) | (1<<TWEN);
 
 	// wail until transmission completed and ACK/NACK has been received
-	while(!(TWCR & (1<<TWINT)));
+	if (i2c_wait_int()) goto fail;
 
 	// check value of TWI Status Register. Mask prescaler bits.
 	twst = TW_STATUS & 0xF8;
-	if ( (twst != TW_MT_SLA_ACK) && (twst != TW_MR_SLA_ACK) ) return 1;
+	if ( (twst != TW_MT_SLA_ACK) && (twst != TW_MR_SLA_ACK) ) goto error;
 
+	i2c_dev_note(address, I2C_OK);
 	return 0;
 
+error:
+	i2c_dev_note(address, (twst == TW_MT_SLA_NACK || twst == TW_MR_SLA_NACK) ? I2C_NACK : I2C_ERROR);
+fail:
+	i2c_stop();
+	return 1;
+
 }/* i2c_start */
 
 
 /*************************************************************************
  Issues a start condition and sends address and transfer direction.
- If device is busy, use ack polling to wait until device is ready
+ If device is busy, use ack polling to wait until device is ready.
+ The polling ends after I2C_START_TRIES attempts.
  
  Input:   address and transfer direction of I2C device
+ Return:  0 device accessible
+          1 failed to access device, bus released
 *************************************************************************/
-void i2c_start_wait(unsigned char address)
+unsigned char i2c_start_wait(unsigned char address)
 {
     uint8_t   twst;
+    uint8_t   tries = I2C_START_TRIES;
 
-
-    while ( 1 )
+	i2c_claim();
+	i2c_cur = address;
+    while ( tries-- )
     {
 	    // send START condition
 	    TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN);
     
     	// wait until transmission completed
-    	while(!(TWCR & (1<<TWINT)));
+    	if (i2c_wait_int()) goto fail;
     
     	// check value of TWI Status Register. Mask prescaler bits.
     	twst = TW_STATUS & 0xF8;
@@ -93,7 +249,7 @@ void i2c_start_wait(unsigned char address)
     	TWCR = (1<<TWINT) | (1<<TWEN);
     
     	// wail until transmission completed
-    	while(!(TWCR & (1<<TWINT)));
+    	if (i2c_wait_int()) goto fail;
     
     	// check value of TWI Status Register. Mask prescaler bits.
     	twst = TW_STATUS & 0xF8;
@@ -103,13 +259,18 @@ void i2c_start_wait(unsigned char address)
 	        TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
 	        
 	        // wait until stop condition is executed and bus released
-	        while(TWCR & (1<<TWSTO));
+	        i2c_wait_stop();
 	        
     	    continue;
     	}
     	//if( twst != TW_MT_SLA_ACK) return 1;
-    	break;
+    	i2c_dev_note(address, I2C_OK);
+    	return 0;
      }
+    i2c_dev_note(address, I2C_NACK);
+fail:
+    i2c_stop();
+    return 1;
 
 }/* i2c_start_wait */
 
@@ -138,7 +299,11 @@ void i2c_stop(void)
 	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
 	
 	// wait until stop condition is executed and bus released
-	while(TWCR & (1<<TWSTO));
+	i2c_wait_stop();
+
+	// hand the bus over to the queue
+	i2c_q_owner = 0;
+	i2c_kick();
 
 }/* i2c_stop */
 
@@ -159,11 +324,15 @@ unsigned char i2c_write( unsigned char data )
 	TWCR = (1<<TWINT) | (1<<TWEN);
 
 	// wait until transmission completed
-	while(!(TWCR & (1<<TWINT)));
+	if (i2c_wait_int()) return 1;
 
 	// check value of TWI Status Register. Mask prescaler bits
 	twst = TW_STATUS & 0xF8;
-	if( twst != TW_MT_DATA_ACK) return 1;
+	if( twst != TW_MT_DATA_ACK)
+	{
+		i2c_dev_note(i2c_cur, I2C_NACK);
+		return 1;
+	}
 	return 0;
 
 }/* i2c_write */
@@ -172,12 +341,12 @@ unsigned char i2c_write( unsigned char data )
 /*************************************************************************
  Read one byte from the I2C device, request more data from device 
  
- Return:  byte read from I2C device
+ Return:  byte read from I2C device, 0xFF after a timeout
 *************************************************************************/
 unsigned char i2c_readAck(void)
 {
 	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWEA);
-	while(!(TWCR & (1<<TWINT)));    
+	if (i2c_wait_int()) return 0xFF;
 
     return TWDR;
 
@@ -187,13 +356,472 @@ unsigned char i2c_readAck(void)
 /*************************************************************************
  Read one byte from the I2C device, read is followed by a stop condition 
  
- Return:  byte read from I2C device
+ Return:  byte read from I2C device, 0xFF after a timeout
 *************************************************************************/
 unsigned char i2c_readNak(void)
 {
 	TWCR = (1<<TWINT) | (1<<TWEN);
-	while(!(TWCR & (1<<TWINT)));
+	if (i2c_wait_int()) return 0xFF;
 	
     return TWDR;
 
 }/* i2c_readNak */
+
+
+/*************************************************************************
+ Bus clear: clock SCL up to nine times until the slave releases SDA and
+ send a STOP, the pins are driven open drain by DDR
+*************************************************************************/
+void i2c_recover(void)
+{
+    uint8_t port = I2C_PORT;
+    uint8_t i;
+
+    TWCR = 0;                           // pins back to the port
+    I2C_PORT &= ~((1<<I2C_SCL_PIN) | (1<<I2C_SDA_PIN));
+    I2C_DDR &= ~((1<<I2C_SCL_PIN) | (1<<I2C_SDA_PIN));
+    for (i = 0; i < 9 && !(I2C_PIN & (1<<I2C_SDA_PIN)); i++)
+    {
+        I2C_DDR |= (1<<I2C_SCL_PIN);        // SCL low
+        _delay_us(5);
+        I2C_DDR &= ~(1<<I2C_SCL_PIN);       // SCL high
+        _delay_us(5);
+    }
+    // STOP: SDA low to high while SCL is high
+    I2C_DDR |= (1<<I2C_SCL_PIN);
+    _delay_us(5);
+    I2C_DDR |= (1<<I2C_SDA_PIN);
+    _delay_us(5);
+    I2C_DDR &= ~(1<<I2C_SCL_PIN);
+    _delay_us(5);
+    I2C_DDR &= ~(1<<I2C_SDA_PIN);
+    _delay_us(5);
+    I2C_PORT = port;
+    TWCR = (1<<TWEN);
+    i2c_recoveries++;
+
+}/* i2c_recover */
+
+
+/*************************************************************************
+ Count the result of an access per device
+*************************************************************************/
+static void i2c_dev_note(uint8_t address, uint8_t status)
+{
+    uint8_t i;
+
+    address &= 0xFE;
+    for (i = 0; i < I2C_DEV_MAX; i++)
+    {
+        if (i2c_dev[i].addr == address || i2c_dev[i].addr == 0) break;
+    }
+    if (i == I2C_DEV_MAX) return;       // table full, not counted
+    i2c_dev[i].addr = address;
+    if (status == I2C_OK)
+    {
+        i2c_dev[i].fail = 0;
+    }
+    else
+    {
+        if (i2c_dev[i].fail < 0xFF) i2c_dev[i].fail++;
+        if (i2c_dev[i].errors < 0xFFFF) i2c_dev[i].errors++;
+    }
+
+}/* i2c_dev_note */
+
+
+/*************************************************************************
+ Error counters of a device
+*************************************************************************/
+static i2c_dev_t *i2c_dev_find(uint8_t address)
+{
+    uint8_t i;
+
+    address &= 0xFE;
+    for (i = 0; i < I2C_DEV_MAX; i++)
+    {
+        if (i2c_dev[i].addr == address) return &i2c_dev[i];
+    }
+    return 0;
+
+}/* i2c_dev_find */
+
+
+/*************************************************************************
+ Return:  errors of the device since start
+*************************************************************************/
+uint16_t i2c_dev_errors(unsigned char address)
+{
+    i2c_dev_t *d = i2c_dev_find(address);
+
+    return d ? d->errors : 0;
+
+}/* i2c_dev_errors */
+
+
+/*************************************************************************
+ Return:  0 after I2C_DEV_FAIL failed accesses in a row, else 1
+*************************************************************************/
+unsigned char i2c_dev_ok(unsigned char address)
+{
+    i2c_dev_t *d = i2c_dev_find(address);
+
+    return !d || d->fail < I2C_DEV_FAIL;
+
+}/* i2c_dev_ok */
+
+/*************************************************************************
+ Start the next queued transaction if the bus is free
+*************************************************************************/
+static void i2c_kick(void)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    if (!i2c_q_run && !i2c_q_owner && !i2c_q_clear && i2c_q_tail != i2c_q_head)
+    {
+        i2c_q_run = 1;
+        i2c_q_idx = 0;
+        i2c_q_read = 0;
+        i2c_q_try = 0;
+        i2c_q_wait = 0;
+        i2c_q_age = 0;
+        i2c_q[i2c_q_tail]->status = I2C_BUSY;
+        i2c_set_scl(i2c_q[i2c_q_tail]->twbr);
+        TWCR = TWCR_IRQ | (1<<TWSTA);
+    }
+    SREG = sreg;
+
+}/* i2c_kick */
+
+
+/*************************************************************************
+ Wait until the queue is empty and take the bus for the blocking API
+*************************************************************************/
+static void i2c_claim(void)
+{
+    uint8_t sreg;
+
+    if (i2c_q_owner) return;            // repeated start
+    for (;;)
+    {
+        sreg = SREG;
+        cli();
+        if (!i2c_q_run && !i2c_q_clear && i2c_q_tail == i2c_q_head)
+        {
+            i2c_q_owner = 1;
+            SREG = sreg;
+            i2c_set_scl(i2c_clk);
+            return;
+        }
+        SREG = sreg;
+        i2c_poll();
+    }
+
+}/* i2c_claim */
+
+
+/*************************************************************************
+ End the running transaction, send STOP and start the next one.
+ Waits I2C_STOP_US at most, a hanging bus is cleared by i2c_poll().
+*************************************************************************/
+static void i2c_finish(uint8_t status, uint8_t stop)
+{
+    i2c_xfer_t *x = i2c_q[i2c_q_tail];
+
+    if (stop)
+    {
+        TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
+        if (i2c_stop_done(I2C_STOP_US)) i2c_q_clear = 1;
+    }
+    else
+    {
+        TWCR = (1<<TWINT) | (1<<TWEN);  // release the bus
+    }
+    i2c_q_tail = (i2c_q_tail + 1) % I2C_QUEUE_SIZE;
+    i2c_q_run = 0;
+    if (x->wlen || x->rlen || status == I2C_OK)
+        i2c_dev_note(x->addr, status);  // an absent address is no device
+    x->status = status;
+    if (x->done) x->done(x);
+    i2c_kick();
+
+}/* i2c_finish */
+
+
+/*************************************************************************
+ Start the running transaction again after an address NACK
+*************************************************************************/
+static void i2c_retry(void)
+{
+    i2c_q_wait = 0;
+    i2c_q_age = 0;
+    i2c_q_idx = 0;
+    i2c_q_read = 0;
+    TWCR = TWCR_IRQ | (1<<TWSTA);
+
+}/* i2c_retry */
+
+
+/*************************************************************************
+ One step of the transaction state machine, called on TWINT
+*************************************************************************/
+static void i2c_step(void)
+{
+    i2c_xfer_t *x = i2c_q[i2c_q_tail];
+
+    i2c_q_age = 0;
+    switch (TW_STATUS & 0xF8)
+    {
+    case TW_START:
+    case TW_REP_START:
+        // write phase first, a probe (no data) is a write too
+        if (!i2c_q_read && (x->wlen || !x->rlen))
+            TWDR = (x->addr & 0xFE) | I2C_WRITE;
+        else
+            TWDR = (x->addr & 0xFE) | I2C_READ;
+        TWCR = TWCR_IRQ;
+        break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        if (i2c_q_idx < x->wlen)
+        {
+            TWDR = x->wbuf[i2c_q_idx++];
+            TWCR = TWCR_IRQ;
+        }
+        else if (x->rlen)
+        {
+            i2c_q_read = 1;             // repeated start for the read phase
+            i2c_q_idx = 0;
+            TWCR = TWCR_IRQ | (1<<TWSTA);
+        }
+        else
+        {
+            i2c_finish(I2C_OK, 1);
+        }
+        break;
+
+    case TW_MR_DATA_ACK:
+        x->rbuf[i2c_q_idx++] = TWDR;
+        /* fall through */
+    case TW_MR_SLA_ACK:
+        // ACK all bytes but the last one
+        if (i2c_q_idx + 1 < x->rlen)
+            TWCR = TWCR_IRQ | (1<<TWEA);
+        else
+            TWCR = TWCR_IRQ;
+        break;
+
+    case TW_MR_DATA_NACK:
+        x->rbuf[i2c_q_idx++] = TWDR;
+        i2c_finish(I2C_OK, 1);
+        break;
+
+    case TW_MT_SLA_NACK:
+    case TW_MR_SLA_NACK:
+        // device busy (e.g. EEPROM write cycle), STOP and try again from
+        // the next i2c_tick(); the NACK of a probe is already the answer
+        if ((x->wlen || x->rlen) && ++i2c_q_try < I2C_RETRIES)
+        {
+            TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
+            i2c_q_wait = 1;             // the bus stays with the queue
+            break;
+        }
+        i2c_finish(I2C_NACK, 1);
+        break;
+
+    case TW_MT_DATA_NACK:
+        i2c_finish(I2C_NACK, 1);
+        break;
+
+    case TW_MT_ARB_LOST:
+        i2c_finish(I2C_ERROR, 0);
+        break;
+
+    default:                            // bus error
+        i2c_finish(I2C_ERROR, 1);
+        break;
+    }
+
+}/* i2c_step */
+
+
+ISR(TWI_vect)
+{
+    i2c_step();
+}
+
+
+/*************************************************************************
+ Queue a transaction, it is started at once if the bus is free
+
+ Input:   descriptor, must stay valid until status is not I2C_PENDING
+ Return:  0 queued
+          1 queue full
+*************************************************************************/
+unsigned char i2c_submit(i2c_xfer_t *x)
+{
+    uint8_t sreg = SREG;
+    uint8_t next;
+
+    cli();
+    next = (i2c_q_head + 1) % I2C_QUEUE_SIZE;
+    if (next == i2c_q_tail)
+    {
+        SREG = sreg;
+        return 1;
+    }
+    x->status = I2C_PENDING;
+    i2c_q[i2c_q_head] = x;
+    i2c_q_head = next;
+    SREG = sreg;
+    i2c_kick();
+    return 0;
+
+}/* i2c_submit */
+
+
+/*************************************************************************
+ Abort a hanging transaction, the bus is cleared by i2c_poll()
+*************************************************************************/
+static void i2c_abort(void)
+{
+    i2c_q_clear = 1;
+    i2c_finish(I2C_TIMEOUT, 0);
+
+}/* i2c_abort */
+
+
+/*************************************************************************
+ Bus clear outside of the ISRs, then the queue goes on
+*************************************************************************/
+static void i2c_clear(void)
+{
+    i2c_recover();                      // TWCR = 0: no TWI_vect meanwhile
+    i2c_q_clear = 0;
+    i2c_kick();
+
+}/* i2c_clear */
+
+
+/*************************************************************************
+ Clear the bus after an abort, call from the main loop, not from an ISR.
+ Runs the state machine while interrupts are disabled: takes 1us without
+ progress, aborts after I2C_TIMEOUT_US, a retry is started after
+ I2C_RETRY_US.
+*************************************************************************/
+void i2c_poll(void)
+{
+    if (i2c_q_clear)
+    {
+        i2c_clear();
+        return;
+    }
+    if ((SREG & (1<<SREG_I)) || !i2c_q_run) return;
+    if (i2c_q_wait)
+    {
+        if (++i2c_q_poll >= I2C_RETRY_US)
+        {
+            i2c_q_poll = 0;
+            i2c_retry();
+        }
+        else
+        {
+            _delay_us(1);
+        }
+    }
+    else if (TWCR & (1<<TWINT))
+    {
+        i2c_q_poll = 0;
+        i2c_step();
+    }
+    else if (++i2c_q_poll >= I2C_TIMEOUT_US)
+    {
+        i2c_q_poll = 0;
+        i2c_abort();
+    }
+    else
+    {
+        _delay_us(1);
+    }
+
+}/* i2c_poll */
+
+
+/*************************************************************************
+ Supervision of the queue, call periodically (e.g. every 100ms) from an
+ ISR. Restarts a transaction after an address NACK, a transaction
+ without progress for 2 calls is aborted. No busy wait.
+*************************************************************************/
+void i2c_tick(void)
+{
+    if (!i2c_q_run) return;
+    if (i2c_q_wait) i2c_retry();
+    else if (++i2c_q_age > 2) i2c_abort();
+
+}/* i2c_tick */
+
+
+/*************************************************************************
+ Queue a transaction and wait for its end
+
+ Input:   descriptor
+ Return:  I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+*************************************************************************/
+unsigned char i2c_transfer(i2c_xfer_t *x)
+{
+    while (i2c_submit(x)) i2c_poll();
+    while (x->status & I2C_PENDING) i2c_poll();
+    return x->status;
+
+}/* i2c_transfer */
+
+
+/*************************************************************************
+ Write a buffer to a device in one transaction
+
+ Input:   device address, bytes, number of bytes
+ Return:  I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+*************************************************************************/
+unsigned char i2c_write_buf(unsigned char addr, const uint8_t *data, uint8_t len)
+{
+    return i2c_write_then_read(addr, data, len, 0, 0);
+
+}/* i2c_write_buf */
+
+
+/*************************************************************************
+ Read a buffer from a device in one transaction
+
+ Input:   device address, buffer, number of bytes (> 0)
+ Return:  I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+*************************************************************************/
+unsigned char i2c_read_buf(unsigned char addr, uint8_t *data, uint8_t len)
+{
+    return i2c_write_then_read(addr, 0, 0, data, len);
+
+}/* i2c_read_buf */
+
+
+/*************************************************************************
+ Write bytes (e.g. a register address) and read with a repeated start
+
+ Input:   device address, bytes to write, number, buffer, number to read
+ Return:  I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
+*************************************************************************/
+unsigned char i2c_write_then_read(unsigned char addr, const uint8_t *wdata, uint8_t wlen,
+                                  uint8_t *rdata, uint8_t rlen)
+{
+    i2c_xfer_t x;
+
+    x.addr = addr;
+    x.wbuf = wdata;
+    x.wlen = wlen;
+    x.rbuf = rdata;
+    x.rlen = rlen;
+    x.done = 0;
+    x.twbr = i2c_clk;
+    return i2c_transfer(&x);
+
+}/* i2c_write_then_read */
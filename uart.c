@@ -523,6 +523,25 @@ void uart_puts_p(const char *progmem_s )
 }/* uart_puts_p */
 
 
+/*************************************************************************
+Function: uart_tx_progress()
+Purpose:  check that the transmitter is not stuck
+Input:    none
+Returns:  1 if the buffer is empty or a byte was sent since the last call
+**************************************************************************/
+unsigned char uart_tx_progress(void)
+{
+    static unsigned char last;
+    unsigned char tail = UART_TxTail;
+    unsigned char ok;
+
+    ok = (UART_TxHead == tail) || (tail != last);
+    last = tail;
+    return ok;
+
+}/* uart_tx_progress */
+
+
 /*
  * these functions are only for ATmegas with two USART
  */
@@ -198,6 +198,14 @@ extern void uart_puts_p(const char *s );
  */
 #define uart_puts_P(__s)       uart_puts_p(PSTR(__s))
 
+/**
+ *  @brief   Check that the transmitter is not stuck, e.g. for a watchdog
+ *  @param   void
+ *  @return  1 if the transmit buffer is empty or a byte was sent since
+ *           the last call, 0 if bytes are waiting without progress
+ */
+extern unsigned char uart_tx_progress(void);
+
 
 
 /** @brief  Initialize USART1 (only available on selected ATmegas) @see uart_init */